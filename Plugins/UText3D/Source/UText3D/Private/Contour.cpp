@@ -89,6 +89,20 @@ void Contour::evaluateCubicCurve(Point A, Point B, Point C, Point D, unsigned sh
 }
 
 
+// The distance between a bezier curve and the chords of n uniform segments
+// is at most max|P''| / (8 n^2), with |P''| bounded by 2 |A - 2B + C| for
+// quadratic and by 6 max(|A - 2B + C|, |B - 2C + D|) for cubic curves.
+unsigned short Contour::CurveSteps(double secondDiff, int degree, double tolerance, unsigned short maxSteps)
+{
+    double maxSecondDerivative = (degree == 2 ? 2.0 : 6.0) * secondDiff;
+    double steps = ceil(sqrt(maxSecondDerivative / (8.0 * tolerance)));
+
+    if(steps < 1.0) return 1;
+    if(steps > maxSteps) return maxSteps;
+    return static_cast<unsigned short>(steps);
+}
+
+
 // This function is a bit tricky. Given a path ABC, it returns the
 // coordinates of the outset point facing B on the left at a distance
 // of 64.0.
@@ -158,7 +172,7 @@ void Contour::SetParity(int parity)
 }
 
 
-Contour::Contour(FT_Vector* contour, char* tags, unsigned int n, unsigned short bezierSteps)
+Contour::Contour(FT_Vector* contour, char* tags, unsigned int n, unsigned short bezierSteps, double tolerance, unsigned short maxSteps)
 {
     Point prev, cur(contour[(n - 1) % n]), next(contour[0]);
     Point a, b = next - cur;
@@ -209,12 +223,30 @@ Contour::Contour(FT_Vector* contour, char* tags, unsigned int n, unsigned short
                 next2 = (cur + next) * 0.5;
             }
 
-            evaluateQuadraticCurve(prev2, cur, next2, bezierSteps);
+            unsigned short steps = bezierSteps;
+            if(tolerance > 0.0)
+            {
+                Point d = prev2 - cur * 2.0 + next2;
+                steps = CurveSteps(sqrt(d.X() * d.X() + d.Y() * d.Y()), 2, tolerance, maxSteps);
+            }
+
+            evaluateQuadraticCurve(prev2, cur, next2, steps);
         }
         else if(FT_CURVE_TAG(tags[i]) == FT_Curve_Tag_Cubic
                  && FT_CURVE_TAG(tags[(i + 1) % n]) == FT_Curve_Tag_Cubic)
         {
-            evaluateCubicCurve(prev, cur, next, Point(contour[(i + 2) % n]), bezierSteps);
+            Point last(contour[(i + 2) % n]);
+            unsigned short steps = bezierSteps;
+            if(tolerance > 0.0)
+            {
+                Point d1 = prev - cur * 2.0 + next;
+                Point d2 = cur - next * 2.0 + last;
+                double secondDiff = FMath::Max(sqrt(d1.X() * d1.X() + d1.Y() * d1.Y()),
+                                               sqrt(d2.X() * d2.X() + d2.Y() * d2.Y()));
+                steps = CurveSteps(secondDiff, 3, tolerance, maxSteps);
+            }
+
+            evaluateCubicCurve(prev, cur, next, last, steps);
         }
     }
 
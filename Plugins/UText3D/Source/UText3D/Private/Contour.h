@@ -319,8 +319,14 @@ private:
          * @param contour
          * @param pointTags
          * @param numberOfPoints
+         * @param bezierSteps  Number of segments per curve.
+         * @param tolerance  Maximum distance between a curve and its
+         *                   segments. If greater than zero each curve gets
+         *                   as many segments as its curvature needs and
+         *                   bezierSteps is ignored.
+         * @param maxSteps  Most segments a curve gets from the tolerance.
          */
-        Contour(FT_Vector* contour, char* pointTags, unsigned int numberOfPoints, unsigned short bezierSteps);
+        Contour(FT_Vector* contour, char* pointTags, unsigned int numberOfPoints, unsigned short bezierSteps, double tolerance = 0.0, unsigned short maxSteps = 64);
 
         /**
          * Destructor
@@ -405,6 +411,17 @@ private:
          */
         void evaluateCubicCurve(Point, Point, Point, Point, unsigned short);
 
+        /**
+         * Compute how many segments a curve needs so that no point of the
+         * curve is further than tolerance from its segments.
+         *
+         * @param secondDiff  Largest second difference of the control
+         *                    points, |A - 2B + C|.
+         * @param degree  2 for quadratic and 3 for cubic curves.
+         * @param maxSteps  Upper bound of the result.
+         */
+        static unsigned short CurveSteps(double secondDiff, int degree, double tolerance, unsigned short maxSteps);
+
         /**
          * Compute the outset point coordinates
          */
@@ -1,22 +1,58 @@
 // Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
 
 #include "Text3D.h"
+#include "Text3DGlyphCache.h"
+#include "Text3DFontFaceCache.h"
+#include "Text3DBuildScheduler.h"
+#include "Text3DStats.h"
 
 #define LOCTEXT_NAMESPACE "FText3DModule"
 
 void FText3DModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+#if WITH_FREETYPE && WITH_HARFBUZZ
+	FText3DFontFaceCache::Get().Startup();
+	FText3DBuildScheduler::Get().Startup();
+#endif
 }
 
 void FText3DModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+#if WITH_FREETYPE && WITH_HARFBUZZ
+	FText3DBuildScheduler::Get().Shutdown();
+	FText3DFontFaceCache::Get().Shutdown();
+#endif
+	FText3DGlyphCache::Get().Empty();
 }
 
 #undef LOCTEXT_NAMESPACE
 	
 IMPLEMENT_MODULE(FText3DModule, Text3D)
 
-DEFINE_LOG_CATEGORY(Text3D)
\ No newline at end of file
+DEFINE_LOG_CATEGORY(Text3D)
+
+DEFINE_STAT(STAT_Text3D_Build);
+DEFINE_STAT(STAT_Text3D_FaceCreation);
+DEFINE_STAT(STAT_Text3D_Shaping);
+DEFINE_STAT(STAT_Text3D_Vectorise);
+DEFINE_STAT(STAT_Text3D_Triangulate);
+DEFINE_STAT(STAT_Text3D_PlaceGlyphs);
+DEFINE_STAT(STAT_Text3D_Transform);
+DEFINE_STAT(STAT_Text3D_Indexing);
+DEFINE_STAT(STAT_Text3D_ApplyMesh);
+DEFINE_STAT(STAT_Text3D_Upload);
+DEFINE_STAT(STAT_Text3D_Glyphs);
+DEFINE_STAT(STAT_Text3D_Triangles);
+DEFINE_STAT(STAT_Text3D_Vertices);
+DEFINE_STAT(STAT_Text3D_GlyphCacheHits);
+DEFINE_STAT(STAT_Text3D_GlyphCacheMisses);
+DEFINE_STAT(STAT_Text3D_ReusedLines);
+DEFINE_STAT(STAT_Text3D_BuildsInFlight);
+DEFINE_STAT(STAT_Text3D_QueuedBuilds);
+DEFINE_STAT(STAT_Text3D_CachedGlyphs);
+DEFINE_STAT(STAT_Text3D_CachedFaces);
+DEFINE_STAT(STAT_Text3D_GlyphCacheMemory);
+DEFINE_STAT(STAT_Text3D_RenderBufferMemory);
\ No newline at end of file
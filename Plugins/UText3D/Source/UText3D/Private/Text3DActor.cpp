@@ -3,4 +3,7 @@
 AText3DActor::AText3DActor()
 {
 	RootComponent = TextComponent = CreateDefaultSubobject<UText3DComponent>(FName("Text"));
+#if WITH_EDITORONLY_DATA
+	BakePath = TEXT("/Game/Text3D");
+#endif
 }
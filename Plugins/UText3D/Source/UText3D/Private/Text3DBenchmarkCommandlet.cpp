@@ -0,0 +1,367 @@
+#include "Text3DBenchmarkCommandlet.h"
+#include "Text3DShaper.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "UObject/Package.h"
+
+#if WITH_FREETYPE && WITH_HARFBUZZ
+
+//samples the physical memory in use on its own thread while a pass runs, so the transient allocations of the builds
+//show up in the peak. the process wide peak of the platform can't be reset and would only grow from sample to sample
+class FText3DMemorySampler : public FRunnable
+{
+public:
+	FText3DMemorySampler()
+	{
+		mBaseline = mPeak = FPlatformMemory::GetStats().UsedPhysical;
+		mThread = FRunnableThread::Create(this, TEXT("Text3DMemorySampler"));
+	}
+	~FText3DMemorySampler()
+	{
+		delete mThread;
+	}
+
+	virtual uint32 Run() override
+	{
+		while (!mStop)
+		{
+			Sample();
+			FPlatformProcess::Sleep(0.0005f);
+		}
+		return 0;
+	}
+	virtual void Stop() override
+	{
+		mStop = true;
+	}
+
+	//stops sampling, returns the peak above the memory in use when the sampler was created, in MB
+	double Finish()
+	{
+		Stop();
+		if (mThread)
+			mThread->WaitForCompletion();
+		Sample();
+		return (mPeak - mBaseline) / (1024.0 * 1024.0);
+	}
+
+private:
+	void Sample()
+	{
+		mPeak = FMath::Max<uint64>(mPeak, FPlatformMemory::GetStats().UsedPhysical);
+	}
+
+	FRunnableThread* mThread = nullptr;
+	FThreadSafeBool mStop;
+	uint64 mBaseline;
+	uint64 mPeak;
+};
+
+//milliseconds spent in each stage of one build
+struct FText3DBenchmarkTimes
+{
+	double mFace = 0;
+	double mShaping = 0;
+	double mVectorise = 0;
+	double mTriangulate = 0;
+	double mPlacement = 0;
+	double mTransform = 0;
+	double mIndexing = 0;
+
+	double Total() const
+	{
+		return mFace + mShaping + mVectorise + mTriangulate + mPlacement + mTransform + mIndexing;
+	}
+	void operator += (const FText3DBenchmarkTimes& other)
+	{
+		mFace += other.mFace;
+		mShaping += other.mShaping;
+		mVectorise += other.mVectorise;
+		mTriangulate += other.mTriangulate;
+		mPlacement += other.mPlacement;
+		mTransform += other.mTransform;
+		mIndexing += other.mIndexing;
+	}
+	void operator /= (double divisor)
+	{
+		mFace /= divisor;
+		mShaping /= divisor;
+		mVectorise /= divisor;
+		mTriangulate /= divisor;
+		mPlacement /= divisor;
+		mTransform /= divisor;
+		mIndexing /= divisor;
+	}
+};
+
+struct FText3DBenchmarkResult
+{
+	int32 mGlyphs = 0;
+	int32 mUniqueGlyphs = 0;
+	int32 mTriangles = 0;
+	int32 mVertices = 0;
+};
+
+//runs the same stages as UText3DComponent::StartBuild on the calling thread and times them
+static FText3DBenchmarkResult BenchmarkBuild(UText3DComponent* component, FText3DBenchmarkTimes& outTimes)
+{
+	FText3DBenchmarkResult result;
+	FTextShaper shaper(component);
+
+	double time = FPlatformTime::Seconds();
+	auto LLap = [&time]()
+	{
+		double now = FPlatformTime::Seconds();
+		double elapsed = (now - time) * 1000.0;
+		time = now;
+		return elapsed;
+	};
+
+	shaper.mFace = FText3DFontFaceCache::Get().Acquire(shaper.mFontKey, shaper.mFontData.ToSharedRef());
+	outTimes.mFace += LLap();
+	if (!shaper.mFace.IsValid())
+		return result;
+
+	shaper.Shape();
+	outTimes.mShaping += LLap();
+
+	//triangulates the missing glyphs here to time the stages separately, PlaceGlyphs only finds cached glyphs then
+	TSet<uint32> uniqueGlyphs;
+	for (const FGlyphPlacement& placement : shaper.mPlacements)
+		uniqueGlyphs.Add(placement.mGlyphIndex);
+
+	for (uint32 glyphIndex : uniqueGlyphs)
+	{
+		const FText3DGlyphKey key = shaper.MakeGlyphKey(glyphIndex);
+		if (FText3DGlyphCache::Get().Find(key).IsValid())
+			continue;
+
+		LLap();
+		TUniquePtr<Vectoriser> vectoriser = shaper.VectoriseGlyph(glyphIndex);
+		outTimes.mVectorise += LLap();
+		if (!vectoriser.IsValid())
+			continue;
+
+		FText3DGlyphMesh* glyphMesh = new FText3DGlyphMesh;
+		shaper.TriangulateGlyph_P2T(*vectoriser, *glyphMesh);
+		FText3DGlyphCache::Get().Add(key, glyphMesh);
+		outTimes.mTriangulate += LLap();
+	}
+
+	LLap();
+	shaper.PlaceGlyphs();
+	outTimes.mPlacement += LLap();
+
+	TUniquePtr<FMeshResultFinal> mesh(shaper.IndexMesh());
+	outTimes.mIndexing += LLap();
+
+	shaper.TransformMesh(*mesh);
+	outTimes.mTransform += LLap();
+
+	result.mGlyphs = shaper.mPlacements.Num();
+	result.mUniqueGlyphs = uniqueGlyphs.Num();
+	for (int iMesh = 0; iMesh < 3; iMesh++)
+	{
+		result.mTriangles += mesh->mMeshes[iMesh].NumIndices() / 3;
+		result.mVertices += mesh->mMeshes[iMesh].NumVertices();
+	}
+	return result;
+}
+
+//vectorises the glyphs of a font with the most contours, the cost of resolving the contour parity grows with the contour count
+static void BenchmarkDensestGlyphs(const FText3DFontFacePtr& face, const FString& fontName, int32 numGlyphs, int32 iterations, int32 bezierStep, float tolerance, FString& csv)
+{
+	FScopeLock faceLock(&face->mLock);
+
+	TArray<TPair<int32, uint32>> glyphContours;
+	for (FT_Long glyphIndex = 0; glyphIndex < face->mFace->num_glyphs; glyphIndex++)
+	{
+		if (FT_Load_Glyph(face->mFace, glyphIndex, FT_LOAD_DEFAULT) == 0 && face->mFace->glyph->format == FT_GLYPH_FORMAT_OUTLINE)
+			glyphContours.Emplace(face->mFace->glyph->outline.n_contours, (uint32)glyphIndex);
+	}
+	glyphContours.Sort([](const TPair<int32, uint32>& a, const TPair<int32, uint32>& b) { return a.Key > b.Key; });
+
+	for (int32 i = 0; i < FMath::Min(numGlyphs, glyphContours.Num()); i++)
+	{
+		const uint32 glyphIndex = glyphContours[i].Value;
+		FT_Load_Glyph(face->mFace, glyphIndex, FT_LOAD_DEFAULT);
+
+		size_t numPoints = 0;
+		const double start = FPlatformTime::Seconds();
+		for (int32 iteration = 0; iteration < iterations; iteration++)
+		{
+			Vectoriser vectoriser(face->mFace->glyph, (unsigned short)bezierStep, tolerance * 64.0);
+			numPoints = vectoriser.PointCount();
+		}
+		const double ms = (FPlatformTime::Seconds() - start) * 1000.0 / iterations;
+
+		csv += FString::Printf(TEXT("%s,%u,%d,%d,%.4f\n"), *fontName, glyphIndex, glyphContours[i].Key, (int32)numPoints, ms);
+	}
+}
+
+static void GetBuiltInSamples(TArray<TPair<FString, FString>>& outSamples)
+{
+	outSamples.Emplace(TEXT("Latin"), TEXT("The quick brown fox jumps over the lazy dog\nSphinx of black quartz, judge my vow 0123456789"));
+	outSamples.Emplace(TEXT("Arabic"), TEXT("\u0645\u0631\u062D\u0628\u0627 \u0628\u0627\u0644\u0639\u0627\u0644\u0645\n\u0627\u0644\u0644\u063A\u0629 \u0627\u0644\u0639\u0631\u0628\u064A\u0629"));
+	outSamples.Emplace(TEXT("CJK"), TEXT("\u4F60\u597D\u4E16\u754C\uFF0C\u6B22\u8FCE\u4F7F\u7528\n\u65E5\u672C\u8A9E\u306E\u30C6\u30AD\u30B9\u30C8\n\uD55C\uAD6D\uC5B4 \uD14D\uC2A4\uD2B8"));
+	outSamples.Emplace(TEXT("Symbols"), TEXT("+-*/=<>()[]{}#%&@$!?\n\u2190\u2191\u2192\u2193 \u221E\u2211\u221A\u2248\u2260\u2264\u2265 \u00A9\u00AE\u2122"));
+}
+
+#endif
+
+UText3DBenchmarkCommandlet::UText3DBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UText3DBenchmarkCommandlet::Main(const FString& Params)
+{
+#if WITH_FREETYPE && WITH_HARFBUZZ
+	FString fontsDir, textsDir, csvPath = FPaths::ProjectSavedDir() / TEXT("Text3DBenchmark.csv");
+	int32 iterations = 10;
+	int32 bezierStep = 3;
+	float tolerance = 0;
+	int32 densestGlyphs = 32;
+
+	if (!FParse::Value(*Params, TEXT("fonts="), fontsDir))
+	{
+		UE_LOG(Text3D, Error, TEXT("usage: -run=Text3DBenchmark -nullrhi -fonts=<dir> [-texts=<dir>] [-iterations=N] [-csv=<file>] [-bezierstep=N] [-tolerance=F] [-densest=N]"));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("texts="), textsDir);
+	FParse::Value(*Params, TEXT("csv="), csvPath);
+	FParse::Value(*Params, TEXT("iterations="), iterations);
+	FParse::Value(*Params, TEXT("bezierstep="), bezierStep);
+	FParse::Value(*Params, TEXT("tolerance="), tolerance);
+	FParse::Value(*Params, TEXT("densest="), densestGlyphs);
+	iterations = FMath::Max(iterations, 2);
+
+	TArray<FString> fontFiles;
+	IFileManager::Get().FindFiles(fontFiles, *(fontsDir / TEXT("*.ttf")), true, false);
+	IFileManager::Get().FindFiles(fontFiles, *(fontsDir / TEXT("*.otf")), true, false);
+	if (fontFiles.Num() == 0)
+	{
+		UE_LOG(Text3D, Error, TEXT("no .ttf or .otf files in %s"), *fontsDir);
+		return 1;
+	}
+
+	TArray<TPair<FString, FString>> samples;
+	if (textsDir.IsEmpty())
+	{
+		GetBuiltInSamples(samples);
+	}
+	else
+	{
+		TArray<FString> textFiles;
+		IFileManager::Get().FindFiles(textFiles, *(textsDir / TEXT("*.txt")), true, false);
+		for (const FString& textFile : textFiles)
+		{
+			FString text;
+			if (FFileHelper::LoadFileToString(text, *(textsDir / textFile)))
+				samples.Emplace(FPaths::GetBaseFilename(textFile), text);
+		}
+	}
+
+	FString csv = TEXT("Font,Sample,Pass,Glyphs,UniqueGlyphs,Triangles,Vertices,FaceMs,ShapingMs,VectoriseMs,TriangulateMs,PlacementMs,TransformMs,IndexingMs,TotalMs,GlyphsPerSec,TrianglesPerSec,UsedBeforeMB,UsedAfterMB,PeakAboveBeforeMB\n");
+	FString contoursCsv = TEXT("Font,GlyphIndex,Contours,Points,VectoriseMs\n");
+	//physical memory in use by the process, sampled around each pass, and its peak during the pass, see FText3DMemorySampler
+	auto LUsedMB = []()
+	{
+		return FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+	};
+	auto LAddRow = [&csv](const FString& font, const FString& sample, const TCHAR* pass, const FText3DBenchmarkResult& result, const FText3DBenchmarkTimes& times, double usedBeforeMB, double usedAfterMB, double peakMB)
+	{
+		const double seconds = FMath::Max(times.Total() / 1000.0, 1e-9);
+		csv += FString::Printf(TEXT("%s,%s,%s,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.0f,%.0f,%.1f,%.1f,%.1f\n"),
+			*font, *sample, pass, result.mGlyphs, result.mUniqueGlyphs, result.mTriangles, result.mVertices,
+			times.mFace, times.mShaping, times.mVectorise, times.mTriangulate, times.mPlacement, times.mTransform, times.mIndexing,
+			times.Total(), result.mGlyphs / seconds, result.mTriangles / seconds, usedBeforeMB, usedAfterMB, peakMB);
+	};
+
+	for (const FString& fontFile : fontFiles)
+	{
+		TArray<uint8> fontData;
+		if (!FFileHelper::LoadFileToArray(fontData, *(fontsDir / fontFile)))
+		{
+			UE_LOG(Text3D, Error, TEXT("failed to read %s"), *fontFile);
+			continue;
+		}
+
+		UFontFace* fontFace = NewObject<UFontFace>(GetTransientPackage());
+		fontFace->FontFaceData->SetData(MoveTemp(fontData));
+
+		UText3DComponent* component = NewObject<UText3DComponent>(GetTransientPackage());
+		component->Font = fontFace;
+		component->BezierStep = bezierStep;
+		component->BezierTolerance = tolerance;
+
+		for (const TPair<FString, FString>& sample : samples)
+		{
+			component->Text = sample.Value;
+
+			//cold pass, nothing of this font is cached
+			FText3DFontFaceCache::Get().Remove(FObjectKey(fontFace));
+			FText3DBenchmarkTimes coldTimes;
+			const double coldBeforeMB = LUsedMB();
+			FText3DMemorySampler* coldSampler = new FText3DMemorySampler;
+			FText3DBenchmarkResult result = BenchmarkBuild(component, coldTimes);
+			const double coldPeakMB = coldSampler->Finish();
+			delete coldSampler;
+			LAddRow(fontFile, sample.Key, TEXT("Cold"), result, coldTimes, coldBeforeMB, LUsedMB(), coldPeakMB);
+
+			FText3DBenchmarkTimes warmTimes;
+			const double warmBeforeMB = LUsedMB();
+			FText3DMemorySampler* warmSampler = new FText3DMemorySampler;
+			for (int32 iteration = 1; iteration < iterations; iteration++)
+				BenchmarkBuild(component, warmTimes);
+			const double warmPeakMB = warmSampler->Finish();
+			delete warmSampler;
+			warmTimes /= iterations - 1;
+			LAddRow(fontFile, sample.Key, TEXT("Warm"), result, warmTimes, warmBeforeMB, LUsedMB(), warmPeakMB);
+
+			UE_LOG(Text3D, Display, TEXT("%s %s: %d glyphs, %d triangles, cold %.3f ms, warm %.3f ms"),
+				*fontFile, *sample.Key, result.mGlyphs, result.mTriangles, coldTimes.Total(), warmTimes.Total());
+		}
+
+		if (densestGlyphs > 0)
+		{
+			FText3DFontFacePtr face = FText3DFontFaceCache::Get().Acquire(FObjectKey(fontFace), fontFace->FontFaceData);
+			if (face.IsValid())
+				BenchmarkDensestGlyphs(face, fontFile, densestGlyphs, iterations, bezierStep, tolerance, contoursCsv);
+		}
+
+		FText3DFontFaceCache::Get().Remove(FObjectKey(fontFace));
+	}
+
+	if (!FFileHelper::SaveStringToFile(csv, *csvPath))
+	{
+		UE_LOG(Text3D, Error, TEXT("failed to write %s"), *csvPath);
+		return 1;
+	}
+	UE_LOG(Text3D, Display, TEXT("results written to %s"), *csvPath);
+
+	if (densestGlyphs > 0)
+	{
+		const FString contoursPath = FPaths::GetPath(csvPath) / FPaths::GetBaseFilename(csvPath) + TEXT("_Contours.csv");
+		if (!FFileHelper::SaveStringToFile(contoursCsv, *contoursPath))
+		{
+			UE_LOG(Text3D, Error, TEXT("failed to write %s"), *contoursPath);
+			return 1;
+		}
+		UE_LOG(Text3D, Display, TEXT("contour results written to %s"), *contoursPath);
+	}
+	return 0;
+#else
+	UE_LOG(Text3D, Error, TEXT("Text3DBenchmark needs FreeType and HarfBuzz"));
+	return 1;
+#endif
+}
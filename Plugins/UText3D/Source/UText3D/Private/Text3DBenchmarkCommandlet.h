@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "Text3DBenchmarkCommandlet.generated.h"
+
+//measures the glyph to mesh pipeline without a running editor or a GPU, e.g
+//UE4Editor-Cmd Text3DProject -run=Text3DBenchmark -nullrhi -fonts=<dir> [-texts=<dir>] [-iterations=10] [-csv=<file>] [-bezierstep=3] [-tolerance=0] [-densest=32]
+//every .ttf/.otf in -fonts is built with every UTF-8 .txt in -texts, or with the built in Latin, Arabic, CJK and symbol samples.
+//the first pass of each pair runs with empty caches, the following passes are averaged as the warm pass.
+//-densest vectorises the glyphs of each font with the most contours and writes them to <csv>_Contours.csv
+UCLASS()
+class UText3DBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UText3DBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,227 @@
+#include "Text3DBuildScheduler.h"
+#include "Text3DComponent.h"
+#include "Text3DShaper.h"
+#include "Text3DStats.h"
+#include "Engine/World.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+
+#if WITH_FREETYPE && WITH_HARFBUZZ
+
+static TAutoConsoleVariable<int32> CVarText3DMaxConcurrentBuilds(
+	TEXT("Text3D.MaxConcurrentBuilds"),
+	2,
+	TEXT("Maximum number of Text3D meshes built at the same time on the worker threads."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarText3DMaxAppliedBuildsPerFrame(
+	TEXT("Text3D.MaxAppliedBuildsPerFrame"),
+	4,
+	TEXT("Maximum number of built Text3D meshes handed to their components per frame, the others wait for the next frames."),
+	ECVF_Default);
+
+//a component rendered within this many seconds is on screen
+static const float GText3DRecentlyRenderedTime = 0.2f;
+
+FText3DBuildScheduler& FText3DBuildScheduler::Get()
+{
+	static FText3DBuildScheduler Instance;
+	return Instance;
+}
+
+void FText3DBuildScheduler::Startup()
+{
+	mShuttingDown = false;
+	mTickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FText3DBuildScheduler::Tick));
+}
+
+void FText3DBuildScheduler::Shutdown()
+{
+	FTicker::GetCoreTicker().RemoveTicker(mTickHandle);
+
+	//the running builds use the scheduler, the face cache and the glyph cache until they are done
+	mShuttingDown = true;
+	while (mNumRunning.GetValue() > 0)
+		FPlatformProcess::Sleep(0.001f);
+
+	for (const FQueuedBuild& build : mQueue)
+	{
+		for (FTextShaper* shaper : build.mShapers)
+			delete shaper;
+	}
+	mQueue.Empty();
+	SET_DWORD_STAT(STAT_Text3D_QueuedBuilds, 0);
+
+	FScopeLock lock(&mFinishedLock);
+	for (const FFinishedBuild& build : mFinished)
+		delete build.mMesh;
+	mFinished.Empty();
+}
+
+void FText3DBuildScheduler::Enqueue(UText3DComponent* component, FTextShaper* shaper)
+{
+	check(IsInGameThread());
+	FQueuedBuild& build = mQueue[mQueue.AddDefaulted()];
+	build.mComponents.Add(component);
+	build.mShapers.Add(shaper);
+	INC_DWORD_STAT(STAT_Text3D_QueuedBuilds);
+}
+
+void FText3DBuildScheduler::EnqueueBatch(const TArray<UText3DComponent*>& components, const TArray<FTextShaper*>& shapers)
+{
+	check(IsInGameThread());
+
+	TMap<FText3DGlyphKey, int32> groups;
+	for (int32 iShaper = 0; iShaper < shapers.Num(); iShaper++)
+	{
+		const FText3DGlyphKey key = shapers[iShaper]->MakeGlyphKey(0);
+		const int32* found = groups.Find(key);
+		const int32 groupIndex = found ? *found : groups.Add(key, mQueue.AddDefaulted());
+
+		FQueuedBuild& build = mQueue[groupIndex];
+		build.mComponents.Add(components[iShaper]);
+		build.mShapers.Add(shapers[iShaper]);
+		INC_DWORD_STAT(STAT_Text3D_QueuedBuilds);
+	}
+}
+
+bool FText3DBuildScheduler::Tick(float deltaTime)
+{
+	//start the most important builds while there are free slots
+	const int32 maxRunning = FMath::Max(CVarText3DMaxConcurrentBuilds.GetValueOnGameThread(), 1);
+	if (mQueue.Num() && mNumRunning.GetValue() < maxRunning)
+	{
+		UpdatePriorities();
+		int32 numStarted = 0;
+		while (numStarted < mQueue.Num() && mNumRunning.GetValue() < maxRunning)
+		{
+			DEC_DWORD_STAT_BY(STAT_Text3D_QueuedBuilds, mQueue[numStarted].mShapers.Num());
+			StartBuild(mQueue[numStarted++]);
+		}
+		mQueue.RemoveAt(0, numStarted);
+	}
+
+	//apply the finished builds in the order they have finished, cancelled builds don't count
+	const int32 maxApplied = FMath::Max(CVarText3DMaxAppliedBuildsPerFrame.GetValueOnGameThread(), 1);
+	TArray<FFinishedBuild> applied;
+	{
+		FScopeLock lock(&mFinishedLock);
+		int32 numTaken = 0;
+		int32 numMeshes = 0;
+		while (numTaken < mFinished.Num() && (numMeshes < maxApplied || mFinished[numTaken].mMesh == nullptr))
+		{
+			if (mFinished[numTaken].mMesh)
+				numMeshes++;
+			numTaken++;
+		}
+		applied.Append(mFinished.GetData(), numTaken);
+		mFinished.RemoveAt(0, numTaken);
+	}
+
+	//a component may start its next build here, it's queued for the next tick
+	for (const FFinishedBuild& build : applied)
+	{
+		if (UText3DComponent* component = build.mComponent.Get())
+			component->FinishBuild(build.mMesh, build.mGeneration);
+		else
+			delete build.mMesh;
+	}
+	return true;
+}
+
+void FText3DBuildScheduler::UpdatePriorities()
+{
+	for (FQueuedBuild& build : mQueue)
+	{
+		build.mVisible = false;
+		build.mDistanceSquared = MAX_flt;
+
+		for (const TWeakObjectPtr<UText3DComponent>& componentPtr : build.mComponents)
+		{
+			const UText3DComponent* component = componentPtr.Get();
+			const UWorld* world = component ? component->GetWorld() : nullptr;
+			if (world == nullptr)
+				continue;
+
+			build.mVisible |= world->GetTimeSeconds() - component->LastRenderTime <= GText3DRecentlyRenderedTime;
+			if (world->ViewLocationsRenderedLastFrame.Num() == 0)
+				build.mDistanceSquared = 0;
+			for (const FVector& viewLocation : world->ViewLocationsRenderedLastFrame)
+				build.mDistanceSquared = FMath::Min(build.mDistanceSquared, FVector::DistSquared(viewLocation, component->Bounds.Origin));
+		}
+	}
+
+	//components on screen before the others, then the nearest first. equal builds keep their order
+	mQueue.StableSort([](const FQueuedBuild& a, const FQueuedBuild& b)
+	{
+		if (a.mVisible != b.mVisible)
+			return a.mVisible;
+		return a.mDistanceSquared < b.mDistanceSquared;
+	});
+}
+
+void FText3DBuildScheduler::StartBuild(const FQueuedBuild& build)
+{
+	//drop the components that have been destroyed or have requested a newer build while this one was queued
+	TArray<FFinishedBuild> finished;
+	TArray<FTextShaper*> textShapers;
+	for (int32 iShaper = 0; iShaper < build.mShapers.Num(); iShaper++)
+	{
+		FTextShaper* textShaper = build.mShapers[iShaper];
+		const FFinishedBuild cancelled{ build.mComponents[iShaper], nullptr, textShaper->mGeneration };
+		if (!build.mComponents[iShaper].IsValid() || textShaper->IsCancelled())
+		{
+			delete textShaper;
+			AddFinished(cancelled);
+			continue;
+		}
+		finished.Add(cancelled);
+		textShapers.Add(textShaper);
+	}
+	if (textShapers.Num() == 0)
+		return;
+
+	mNumRunning.Increment();
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, textShapers, finished]() mutable {
+		{
+			SCOPE_CYCLE_COUNTER(STAT_Text3D_Build);
+			INC_DWORD_STAT_BY(STAT_Text3D_BuildsInFlight, textShapers.Num());
+
+			if (textShapers.Num() == 1)
+			{
+				FTextShaper* textShaper = textShapers[0];
+				UText3DComponent::GenerateMesh(textShaper);
+				finished[0].mMesh = textShaper->IsCancelled() ? nullptr : textShaper->GetMesh();
+			}
+			else
+			{
+				TArray<FMeshResultFinal*> meshes;
+				UText3DComponent::GenerateMeshes(textShapers, meshes);
+				for (int32 iShaper = 0; iShaper < textShapers.Num(); iShaper++)
+					finished[iShaper].mMesh = meshes[iShaper];
+			}
+
+			for (FTextShaper* textShaper : textShapers)
+				delete textShaper;
+
+			DEC_DWORD_STAT_BY(STAT_Text3D_BuildsInFlight, textShapers.Num());
+		}
+		for (const FFinishedBuild& build : finished)
+		{
+			if (mShuttingDown)
+				delete build.mMesh;
+			else
+				AddFinished(build);
+		}
+		mNumRunning.Decrement();
+	});
+}
+
+void FText3DBuildScheduler::AddFinished(const FFinishedBuild& build)
+{
+	FScopeLock lock(&mFinishedLock);
+	mFinished.Add(build);
+}
+
+#endif
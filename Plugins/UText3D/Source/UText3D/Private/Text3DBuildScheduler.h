@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/ScopeLock.h"
+#include "Containers/Ticker.h"
+
+#if WITH_FREETYPE && WITH_HARFBUZZ
+
+class UText3DComponent;
+struct FTextShaper;
+struct FMeshResultFinal;
+
+//runs the builds of every UText3DComponent. queued builds start in priority order, components on screen and near
+//a view first, with at most Text3D.MaxConcurrentBuilds builds or batches on the background worker threads. at most
+//Text3D.MaxAppliedBuildsPerFrame finished meshes are handed to their components per frame, so a level full of
+//text doesn't spike a single frame. everything except the builds themselves runs on the game thread
+class FText3DBuildScheduler
+{
+public:
+	static FText3DBuildScheduler& Get();
+
+	void Startup();
+	//waits for the running builds, their meshes are dropped
+	void Shutdown();
+
+	//queues the build of a component, the scheduler owns the shaper then
+	void Enqueue(UText3DComponent* component, FTextShaper* shaper);
+	//queues the builds of many components. the components with the same font and glyph settings are built as one
+	//group, see UText3DComponent::GenerateMeshes
+	void EnqueueBatch(const TArray<UText3DComponent*>& components, const TArray<FTextShaper*>& shapers);
+
+private:
+	//components built together, a single component most of the time
+	struct FQueuedBuild
+	{
+		TArray<TWeakObjectPtr<UText3DComponent>, TInlineAllocator<1>> mComponents;
+		TArray<FTextShaper*, TInlineAllocator<1>> mShapers;
+		bool mVisible;	//any of the components has been rendered recently, see UpdatePriorities
+		float mDistanceSquared;	//from the nearest component to the nearest view
+	};
+	struct FFinishedBuild
+	{
+		TWeakObjectPtr<UText3DComponent> mComponent;
+		FMeshResultFinal* mMesh;	//null if the build has been cancelled or has failed
+		int32 mGeneration;
+	};
+
+	bool Tick(float deltaTime);
+	void UpdatePriorities();
+	void StartBuild(const FQueuedBuild& build);
+	//called by the worker threads
+	void AddFinished(const FFinishedBuild& build);
+
+	TArray<FQueuedBuild> mQueue;
+	FThreadSafeCounter mNumRunning;
+	FThreadSafeBool mShuttingDown;	//set by Shutdown, running builds drop their meshes instead of adding them
+	FCriticalSection mFinishedLock;
+	TArray<FFinishedBuild> mFinished;
+	FDelegateHandle mTickHandle;
+};
+
+#endif
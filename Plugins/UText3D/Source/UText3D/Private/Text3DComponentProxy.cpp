@@ -4,38 +4,141 @@
 #include "RenderResource.h"
 #include "RenderingThread.h"
 #include "PrimitiveSceneProxy.h"
+#include "PrimitiveUniformShaderParameters.h"
 #include "Containers/ResourceArray.h"
 #include "EngineGlobals.h"
 #include "VertexFactory.h"
 #include "MaterialShared.h"
 #include "Materials/Material.h"
 #include "LocalVertexFactory.h"
+#include "InstancedStaticMesh.h"
 #include "Engine/Engine.h"
 #include "SceneManagement.h"
 #include "DynamicMeshBuilder.h"
+#include "Text3DStats.h"
+#include "Text3DVertexFormat.h"
 
 
+//the sections of every LOD, or of every glyph of instanced text, packed one after another into a single
+//vertex and index buffer. indices stay relative to their section, the mesh batch of a section adds its base vertex
+struct FText3DBufferLayout
+{
+	struct FRange
+	{
+		const FResultMeshData* Mesh;
+		uint32 BaseVertex;
+		uint32 FirstIndex;
+	};
+	TArray<FRange, TInlineAllocator<3 * FMeshResultFinal::MaxLODs>> Ranges;
+	uint32 NumVertices = 0;
+	uint32 NumIndices = 0;
+	uint32 VertexStride = sizeof(FTextMeshVertex);
+	uint32 IndexStride = sizeof(uint16);
+
+	void Reset()
+	{
+		Ranges.Reset();
+		NumVertices = NumIndices = 0;
+		VertexStride = sizeof(FTextMeshVertex);
+		IndexStride = sizeof(uint16);
+	}
+	//appends a mesh, returns its range
+	const FRange& Add(const FResultMeshData& Mesh)
+	{
+		FRange& range = Ranges[Ranges.AddUninitialized()];
+		range.Mesh = &Mesh;
+		range.BaseVertex = NumVertices;
+		range.FirstIndex = NumIndices;
+		NumVertices += Mesh.NumVertices();
+		NumIndices += Mesh.NumIndices();
+		//the meshes share the vertex format, but one of them may need 32 bit indices
+		VertexStride = Mesh.GetVertexStride();
+		IndexStride = FMath::Max(IndexStride, Mesh.GetIndexStride());
+		return range;
+	}
+	uint32 GetVertexSize() const { return NumVertices * VertexStride; }
+	uint32 GetIndexSize() const { return NumIndices * IndexStride; }
+
+	void WriteVertices(void* Dst) const
+	{
+		uint8* dst = (uint8*)Dst;
+		for (const FRange& range : Ranges)
+			FMemory::Memcpy(dst + range.BaseVertex * VertexStride, range.Mesh->GetVertexData(), range.Mesh->NumVertices() * VertexStride);
+	}
+	void WriteIndices(void* Dst) const
+	{
+		uint8* dst = (uint8*)Dst;
+		for (const FRange& range : Ranges)
+		{
+			const FResultMeshData& mesh = *range.Mesh;
+			if (mesh.GetIndexStride() == IndexStride)
+			{
+				FMemory::Memcpy(dst + range.FirstIndex * IndexStride, mesh.GetIndexData(), mesh.NumIndices() * IndexStride);
+			}
+			else
+			{
+				uint32* dstIndices = (uint32*)(dst + range.FirstIndex * IndexStride);
+				for (int32 iIndex = 0; iIndex < mesh.NumIndices(); iIndex++)
+					dstIndices[iIndex] = mesh.GetIndex(iIndex);
+			}
+		}
+	}
+};
+
 class FText3DVertexBuffer : public FVertexBuffer
 {
 public:
 	unsigned mNumVertices = 0;
-	const TArray<FTextMeshVertex>* mVertices = nullptr;
+	unsigned mCapacity = 0;	//in bytes
+	uint32 mUsage = BUF_Static;
+	const FText3DBufferLayout* mLayout = nullptr;
 
-	void Init(const TArray<FTextMeshVertex>& Vertices)
+	void Init(const FText3DBufferLayout& Layout)
 	{
-		mNumVertices = Vertices.Num();
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Upload);
+
+		mNumVertices = Layout.NumVertices;
+		const uint32 SizeInBytes = Layout.GetVertexSize();
+		mCapacity = SizeInBytes;
+		INC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
 
-		const uint32 SizeInBytes = Vertices.Num() * Vertices.GetTypeSize();
 		void* DataMapped = nullptr;
 		FRHIResourceCreateInfo ci;
-		VertexBufferRHI = RHICreateAndLockVertexBuffer(SizeInBytes, BUF_Static, ci, DataMapped);
-		FMemory::Memcpy(DataMapped, Vertices.GetData(), SizeInBytes);
+		VertexBufferRHI = RHICreateAndLockVertexBuffer(SizeInBytes, mUsage, ci, DataMapped);
+		Layout.WriteVertices(DataMapped);
+		RHIUnlockVertexBuffer(VertexBufferRHI);
+	}
+	//writes the vertices into the existing buffer, a new one is created only if they don't fit
+	void Update_RenderThread(const FText3DBufferLayout& Layout)
+	{
+		check(IsInRenderingThread());
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Upload);
+
+		const uint32 SizeInBytes = Layout.GetVertexSize();
+		if (SizeInBytes > mCapacity)
+		{
+			DEC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+			//some slack so that a growing text doesn't reallocate on every update
+			mCapacity = SizeInBytes + SizeInBytes / 2;
+			INC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+			FRHIResourceCreateInfo ci;
+			VertexBufferRHI = RHICreateVertexBuffer(mCapacity, mUsage, ci);
+		}
+		mNumVertices = Layout.NumVertices;
+
+		void* DataMapped = RHILockVertexBuffer(VertexBufferRHI, 0, SizeInBytes, RLM_WriteOnly);
+		Layout.WriteVertices(DataMapped);
 		RHIUnlockVertexBuffer(VertexBufferRHI);
 	}
 	virtual void InitRHI() override
 	{
-		Init(*mVertices);
-		mVertices = nullptr;
+		Init(*mLayout);
+	}
+	virtual void ReleaseRHI() override
+	{
+		DEC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+		mCapacity = 0;
+		FVertexBuffer::ReleaseRHI();
 	}
 };
 
@@ -44,75 +147,277 @@ class FText3DIndexBuffer : public FIndexBuffer
 {
 public:
 	unsigned mNumIndices = 0;
-	const TArray<int32>* mIndices = nullptr;
+	unsigned mCapacity = 0;	//in bytes
+	uint32 mStride = 0;
+	uint32 mUsage = BUF_Static;
+	const FText3DBufferLayout* mLayout = nullptr;
 
-	void Init(const TArray<int32>& Indices)
+	void Init(const FText3DBufferLayout& Layout)
 	{
-		mNumIndices = Indices.Num();
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Upload);
+
+		mNumIndices = Layout.NumIndices;
+		mStride = Layout.IndexStride;
+		const uint32 SizeInBytes = Layout.GetIndexSize();
+		mCapacity = SizeInBytes;
+		INC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
 
 		FRHIResourceCreateInfo CreateInfo;
 		void* Buffer = nullptr;
-		IndexBufferRHI = RHICreateAndLockIndexBuffer(sizeof(int32), Indices.Num() * sizeof(int32), BUF_Static, CreateInfo, Buffer);
-		FMemory::Memcpy(Buffer, Indices.GetData(), Indices.Num() * sizeof(int32));
+		IndexBufferRHI = RHICreateAndLockIndexBuffer(mStride, SizeInBytes, mUsage, CreateInfo, Buffer);
+		Layout.WriteIndices(Buffer);
+		RHIUnlockIndexBuffer(IndexBufferRHI);
+	}
+	//writes the indices into the existing buffer, a new one is created only if they don't fit or the index size has changed
+	void Update_RenderThread(const FText3DBufferLayout& Layout)
+	{
+		check(IsInRenderingThread());
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Upload);
+
+		const uint32 SizeInBytes = Layout.GetIndexSize();
+		if (SizeInBytes > mCapacity || Layout.IndexStride != mStride)
+		{
+			DEC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+			mCapacity = SizeInBytes + SizeInBytes / 2;
+			mStride = Layout.IndexStride;
+			INC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+			FRHIResourceCreateInfo CreateInfo;
+			IndexBufferRHI = RHICreateIndexBuffer(mStride, mCapacity, mUsage, CreateInfo);
+		}
+		mNumIndices = Layout.NumIndices;
+
+		void* Buffer = RHILockIndexBuffer(IndexBufferRHI, 0, SizeInBytes, RLM_WriteOnly);
+		Layout.WriteIndices(Buffer);
 		RHIUnlockIndexBuffer(IndexBufferRHI);
 	}
 	
 	virtual void InitRHI() override
 	{
-		Init(*mIndices);
-		mIndices = nullptr;
+		Init(*mLayout);
+	}
+	virtual void ReleaseRHI() override
+	{
+		DEC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+		mCapacity = 0;
+		FIndexBuffer::ReleaseRHI();
+	}
+};
+
+/** Instance Buffer, the offsets of every instanced glyph one after another in the order of FMeshResultFinal::mGlyphs */
+class FText3DInstanceBuffer : public FVertexBuffer
+{
+public:
+	unsigned mNumInstances = 0;
+	unsigned mCapacity = 0;	//in bytes
+	uint32 mUsage = BUF_Static;
+	const FMeshResultFinal* mMesh = nullptr;
+
+	static unsigned CountInstances(const FMeshResultFinal& Mesh)
+	{
+		unsigned numInstances = 0;
+		for (const FMeshResultGlyph& glyph : Mesh.mGlyphs)
+			numInstances += glyph.mOffsets.Num();
+		return numInstances;
+	}
+	//the glyphs only move, so every instance has an identity rotation and scale
+	static void WriteInstances(const FMeshResultFinal& Mesh, void* Dst)
+	{
+		FText3DInstanceVertex* dst = (FText3DInstanceVertex*)Dst;
+		for (const FMeshResultGlyph& glyph : Mesh.mGlyphs)
+		{
+			for (const FVector& offset : glyph.mOffsets)
+			{
+				dst->Origin = FVector4(offset, 0);
+				dst->Transform[0] = FVector4(1, 0, 0, 0);
+				dst->Transform[1] = FVector4(0, 1, 0, 0);
+				dst->Transform[2] = FVector4(0, 0, 1, 0);
+				FMemory::Memzero(dst->LightmapAndShadowMapUVBias);
+				dst++;
+			}
+		}
+	}
+
+	void Init(const FMeshResultFinal& Mesh)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Upload);
+
+		mNumInstances = CountInstances(Mesh);
+		const uint32 SizeInBytes = mNumInstances * sizeof(FText3DInstanceVertex);
+		mCapacity = SizeInBytes;
+		INC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+
+		void* DataMapped = nullptr;
+		FRHIResourceCreateInfo ci;
+		VertexBufferRHI = RHICreateAndLockVertexBuffer(SizeInBytes, mUsage, ci, DataMapped);
+		WriteInstances(Mesh, DataMapped);
+		RHIUnlockVertexBuffer(VertexBufferRHI);
+	}
+	//writes the instances into the existing buffer, a new one is created only if they don't fit
+	void Update_RenderThread(const FMeshResultFinal& Mesh)
+	{
+		check(IsInRenderingThread());
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Upload);
+
+		mMesh = &Mesh;
+		mNumInstances = CountInstances(Mesh);
+		const uint32 SizeInBytes = mNumInstances * sizeof(FText3DInstanceVertex);
+		if (SizeInBytes > mCapacity)
+		{
+			DEC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+			mCapacity = SizeInBytes + SizeInBytes / 2;
+			INC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+			FRHIResourceCreateInfo ci;
+			VertexBufferRHI = RHICreateVertexBuffer(mCapacity, mUsage, ci);
+		}
+
+		void* DataMapped = RHILockVertexBuffer(VertexBufferRHI, 0, SizeInBytes, RLM_WriteOnly);
+		WriteInstances(Mesh, DataMapped);
+		RHIUnlockVertexBuffer(VertexBufferRHI);
+	}
+	virtual void InitRHI() override
+	{
+		Init(*mMesh);
+	}
+	virtual void ReleaseRHI() override
+	{
+		DEC_MEMORY_STAT_BY(STAT_Text3D_RenderBufferMemory, mCapacity);
+		mCapacity = 0;
+		FVertexBuffer::ReleaseRHI();
 	}
 };
 
+//binds the vertices of the text to the position and normal streams of a vertex factory
+static void SetupTextStreams(const FText3DVertexBuffer* VertexBuffer, EText3DVertexFormat Format, FLocalVertexFactory::FDataType& NewData)
+{
+	if (Format == EText3DVertexFormat::PACKED_NORMAL)
+	{
+		NewData.PositionComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FText3DPackedVertex, Position, VET_Float3);
+		NewData.TangentBasisComponents[0] = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FText3DPackedVertex, Normal, VET_PackedNormal);
+	}
+	else
+	{
+		NewData.PositionComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FTextMeshVertex, Position, VET_Float3);
+		NewData.TangentBasisComponents[0] = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FTextMeshVertex, Normal, VET_Float3);
+	}
+	NewData.TextureCoordinates.Add(
+		FVertexStreamComponent(VertexBuffer, 0, 0, VET_Float2)
+	);
+	NewData.TangentBasisComponents[1] = FVertexStreamComponent(&GNullColorVertexBuffer, 0, 0, VET_PackedNormal);
+		//STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FDynamicMeshVertex, TangentZ, VET_PackedNormal);
+// 	NewData.ColorComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FDynamicMeshVertex, Color, VET_Color);
+}
+
 /** Vertex Factory */
 class FText3DVertexFactory : public FLocalVertexFactory
 {
 public:
 
 	/** Init function that should only be called on render thread. */
-	void Init_RenderThread(const FText3DVertexBuffer* VertexBuffer)
+	void Init_RenderThread(const FText3DVertexBuffer* VertexBuffer, EText3DVertexFormat Format)
 	{
 		check(IsInRenderingThread());
 		// Initialize the vertex factory's stream components.
 		FDataType NewData;
-		NewData.PositionComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FTextMeshVertex, Position, VET_Float3);
-		NewData.TextureCoordinates.Add(
-			FVertexStreamComponent(VertexBuffer, 0, 0, VET_Float2)
-		);
-		NewData.TangentBasisComponents[0] = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FTextMeshVertex, Normal, VET_Float3);
-		NewData.TangentBasisComponents[1] = FVertexStreamComponent(&GNullColorVertexBuffer, 0, 0, VET_PackedNormal);
-			//STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FDynamicMeshVertex, TangentZ, VET_PackedNormal);
-// 		NewData.ColorComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FDynamicMeshVertex, Color, VET_Color);
+		SetupTextStreams(VertexBuffer, Format, NewData);
 		SetData(NewData);
 	}
 
 	/** Init function that can be called on any thread, and will do the right thing (enqueue command if called on main thread) */
-	void Init(const FText3DVertexBuffer* VertexBuffer)
+	void Init(const FText3DVertexBuffer* VertexBuffer, EText3DVertexFormat Format)
 	{
 		if (IsInRenderingThread())
 		{
-			Init_RenderThread(VertexBuffer);
+			Init_RenderThread(VertexBuffer, Format);
 		}
 		else
 		{
 			ENQUEUE_RENDER_COMMAND(CreateVF)(
 				[=](FRHICommandListImmediate& RHICmdList) {
-					this->Init_RenderThread(VertexBuffer);
+					this->Init_RenderThread(VertexBuffer, Format);
+				}
+			);
+		}
+	}
+};
+
+/** Vertex Factory of instanced text, the vertices of the glyphs with a per instance stream of their offsets */
+class FText3DInstancedVertexFactory : public FInstancedStaticMeshVertexFactory
+{
+public:
+
+	/** Init function that should only be called on render thread. */
+	void Init_RenderThread(const FText3DVertexBuffer* VertexBuffer, const FText3DInstanceBuffer* InstanceBuffer, EText3DVertexFormat Format)
+	{
+		check(IsInRenderingThread());
+		FDataType NewData;
+		SetupTextStreams(VertexBuffer, Format, NewData);
+
+		const uint32 stride = sizeof(FText3DInstanceVertex);
+		NewData.InstanceOriginComponent = FVertexStreamComponent(InstanceBuffer, STRUCT_OFFSET(FText3DInstanceVertex, Origin), stride, VET_Float4, true);
+		for (int32 iRow = 0; iRow < 3; iRow++)
+			NewData.InstanceTransformComponent[iRow] = FVertexStreamComponent(InstanceBuffer, STRUCT_OFFSET(FText3DInstanceVertex, Transform) + iRow * sizeof(FVector4), stride, VET_Float4, true);
+		NewData.InstanceLightmapAndShadowMapUVBiasComponent = FVertexStreamComponent(InstanceBuffer, STRUCT_OFFSET(FText3DInstanceVertex, LightmapAndShadowMapUVBias), stride, VET_Short4N, true);
+		SetData(NewData);
+	}
+
+	/** Init function that can be called on any thread, and will do the right thing (enqueue command if called on main thread) */
+	void Init(const FText3DVertexBuffer* VertexBuffer, const FText3DInstanceBuffer* InstanceBuffer, EText3DVertexFormat Format)
+	{
+		if (IsInRenderingThread())
+		{
+			Init_RenderThread(VertexBuffer, InstanceBuffer, Format);
+		}
+		else
+		{
+			ENQUEUE_RENDER_COMMAND(CreateInstancedVF)(
+				[=](FRHICommandListImmediate& RHICmdList) {
+					this->Init_RenderThread(VertexBuffer, InstanceBuffer, Format);
 				}
 			);
 		}
 	}
 };
 
-/** Class representing a single section of the proc mesh */
+/** Class representing a single section of the proc mesh, a range of the shared buffers with its own material */
 struct FTextMeshSection
 {
+	unsigned MeshIndex = 0;	//index in FMeshResultFinal::mMeshes
 	UMaterialInterface* Material = nullptr;
-	FText3DVertexBuffer VertexBuffer;
-	FText3DIndexBuffer IndexBuffer;
-	FText3DVertexFactory VertexFactory;
+	uint32 FirstIndex = 0;
+	uint32 NumIndices = 0;
+	uint32 BaseVertex = 0;
+	uint32 NumVertices = 0;
+};
+
+//the sections of a level of detail
+struct FTextMeshLOD
+{
+	FTextMeshSection Sections[3];
+	unsigned NumSections = 0;
+	float ScreenSize = FLT_MAX;	//drawn at this screen size and below, until a coarser LOD takes over
+};
+
+//the sections of a distinct glyph of instanced text, each one drawn once for all the instances of the glyph
+struct FTextMeshGlyph
+{
+	FTextMeshSection Sections[3];
+	unsigned NumSections = 0;
+	uint32 InstanceRun[2] = {};	//first and last instance of the glyph in the instance buffer
 };
 
+//finds the meshes that get a section, returns the number of sections
+static unsigned GatherSections(const bool bGenerate[3], const FResultMeshData Meshes[3], unsigned OutMeshIndices[3])
+{
+	unsigned numSections = 0;
+	for (unsigned meshIndex = 0; meshIndex < 3; meshIndex++)
+	{
+		if (bGenerate[meshIndex] && Meshes[meshIndex].NumVertices() >= 3)
+			OutMeshIndices[numSections++] = meshIndex;
+	}
+	return numSections;
+}
+
+
 class FText3DSceneProxy : public FPrimitiveSceneProxy
 {
 public:
@@ -127,48 +432,281 @@ public:
 		MaterialRelevance = Component->GetMaterialRelevance(GetScene().GetFeatureLevel());
 		
 		
-		////////////
-		auto LGenSection = [=](unsigned meshIndex)
+		//dynamic text is updated in place and isn't worth adding to the static draw lists.
+		//a mesh being rebuilt is about to be replaced, it is drawn dynamically until then
+		mDynamicText = Component->bDynamicText;
+		mDrawDynamic = mDynamicText || Component->IsBuildInFlight();
+		const uint32 bufferUsage = mDynamicText ? BUF_Dynamic : BUF_Static;
+
+		mGenerate[0] = Component->bGenerateFronFace;
+		mGenerate[1] = Component->bGenerateBackFace;
+		mGenerate[2] = Component->bGenerateSide;
+		for (int32 iMaterial = 0; iMaterial < 3; iMaterial++)
+		{
+			mMaterials[iMaterial] = Component->GetMaterial(iMaterial);
+			if (!mMaterials[iMaterial])
+				mMaterials[iMaterial] = UMaterial::GetDefaultMaterial(MD_Surface);
+		}
+
+		//instanced text has its glyphs instead of LODs, they are drawn with the instanced static mesh vertex factory
+		mInstanced = mMesh->IsInstanced();
+		for (int32 iMaterial = 0; mInstanced && iMaterial < 3; iMaterial++)
+		{
+			if (!mMaterials[iMaterial]->CheckMaterialUsage_Concurrent(MATUSAGE_InstancedStaticMeshes))
+				mMaterials[iMaterial] = UMaterial::GetDefaultMaterial(MD_Surface);
+		}
+		mNumLODs = mInstanced ? 0 : mMesh->NumLODs();
+		for (unsigned iLOD = 0; iLOD < mNumLODs; iLOD++)
+		{
+			FTextMeshLOD& lod = mLODs[iLOD];
+			lod.ScreenSize = iLOD == 0 ? FLT_MAX : Component->LODScreenSize / (1 << (iLOD - 1));
+
+			unsigned meshIndices[3];
+			lod.NumSections = GatherSections(mGenerate, mMesh->GetLODMeshes(iLOD), meshIndices);
+			for (unsigned iSection = 0; iSection < lod.NumSections; iSection++)
+			{
+				FTextMeshSection& section = lod.Sections[iSection];
+				section.MeshIndex = meshIndices[iSection];
+				section.Material = mMaterials[section.MeshIndex];
+			}
+		}
+
+		UpdateLayout();
+		if (mLayout.Ranges.Num() == 0 || (!mInstanced && mLODs[0].NumSections == 0))
+			return;
+
+		mFormat = mLayout.Ranges[0].Mesh->format;
+		mHasBuffers = true;
+
+		//one vertex buffer, index buffer and vertex factory for all the sections of all the LODs or glyphs
+		mVertexBuffer.mLayout = &mLayout;
+		mVertexBuffer.mUsage = bufferUsage;
+		mIndexBuffer.mLayout = &mLayout;
+		mIndexBuffer.mUsage = bufferUsage;
+
+		BeginInitResource(&mVertexBuffer);
+		BeginInitResource(&mIndexBuffer);
+		if (mInstanced)
+		{
+			mInstanceBuffer.mMesh = mMesh.Get();
+			mInstanceBuffer.mUsage = bufferUsage;
+			mInstanceVertexFactory.Init(&mVertexBuffer, &mInstanceBuffer, mFormat);
+			BeginInitResource(&mInstanceBuffer);
+			BeginInitResource(&mInstanceVertexFactory);
+		}
+		else
+		{
+			mVertexFactory.Init(&mVertexBuffer, mFormat);
+			BeginInitResource(&mVertexFactory);
+		}
+	}
+
+	//packs the sections of mMesh into mLayout and updates their ranges, the sections of the glyphs are gathered again
+	void UpdateLayout()
+	{
+		mLayout.Reset();
+		for (unsigned iLOD = 0; iLOD < mNumLODs; iLOD++)
+		{
+			FTextMeshLOD& lod = mLODs[iLOD];
+			const FResultMeshData* meshes = mMesh->GetLODMeshes(iLOD);
+			for (unsigned iSection = 0; iSection < lod.NumSections; iSection++)
+				SetRange(lod.Sections[iSection], meshes[lod.Sections[iSection].MeshIndex]);
+		}
+
+		mGlyphs.Reset();
+		uint32 numInstances = 0;
+		for (const FMeshResultGlyph& meshGlyph : mMesh->mGlyphs)
 		{
-			FTextMeshSection& section = mSections[mNumSelection];
-			FResultMeshData& mesh = mMesh->mMeshes[meshIndex];
-			
-			if (mesh.vertices.Num() < 3)return;
+			FTextMeshGlyph& glyph = mGlyphs[mGlyphs.AddDefaulted()];
+			glyph.InstanceRun[0] = numInstances;
+			numInstances += meshGlyph.mOffsets.Num();
+			glyph.InstanceRun[1] = numInstances - 1;
+
+			unsigned meshIndices[3];
+			glyph.NumSections = GatherSections(mGenerate, meshGlyph.mMeshes, meshIndices);
+			for (unsigned iSection = 0; iSection < glyph.NumSections; iSection++)
+			{
+				FTextMeshSection& section = glyph.Sections[iSection];
+				section.MeshIndex = meshIndices[iSection];
+				section.Material = mMaterials[section.MeshIndex];
+				SetRange(section, meshGlyph.mMeshes[section.MeshIndex]);
+			}
+		}
+	}
+	void SetRange(FTextMeshSection& Section, const FResultMeshData& Mesh)
+	{
+		const FText3DBufferLayout::FRange& range = mLayout.Add(Mesh);
+		Section.FirstIndex = range.FirstIndex;
+		Section.NumIndices = Mesh.NumIndices();
+		Section.BaseVertex = range.BaseVertex;
+		Section.NumVertices = Mesh.NumVertices();
+	}
 
-			section.VertexBuffer.mVertices = &(mesh.vertices);
-			section.IndexBuffer.mIndices = &(mesh.indices);
-			section.Material = Component->GetMaterial(meshIndex);
-			if (!section.Material)
-				section.Material = UMaterial::GetDefaultMaterial(MD_Surface);
+	//true if the mesh has the same LODs and sections as this proxy, so it can be updated in place.
+	//the sections of instanced text may change, only its parts and vertex format have to match
+	bool CanUpdateInPlace(const UText3DComponent* Component, const FMeshResultFinal& Mesh) const
+	{
+		if (!mDynamicText || !Component->bDynamicText || !mHasBuffers || Mesh.IsInstanced() != mInstanced)
+			return false;
 
-			section.VertexFactory.Init(&section.VertexBuffer);
+		const bool bGenerate[3] = { Component->bGenerateFronFace, Component->bGenerateBackFace, Component->bGenerateSide };
+		if (FMemory::Memcmp(bGenerate, mGenerate, sizeof(mGenerate)) != 0)
+			return false;
 
-			
+		if (mInstanced)
+		{
+			//the vertex factory is bound to the vertex format
+			for (const FMeshResultGlyph& glyph : Mesh.mGlyphs)
+			{
+				for (int32 iMesh = 0; iMesh < 3; iMesh++)
+				{
+					if (glyph.mMeshes[iMesh].NumVertices() >= 3 && glyph.mMeshes[iMesh].format != mFormat)
+						return false;
+				}
+			}
+			return true;
+		}
 
-			BeginInitResource(&(section.VertexBuffer));
-			BeginInitResource(&(section.IndexBuffer));
-			BeginInitResource(&(section.VertexFactory));
+		if ((unsigned)Mesh.NumLODs() != mNumLODs)
+			return false;
 
-			this->mNumSelection++;
-		};
+		for (unsigned iLOD = 0; iLOD < mNumLODs; iLOD++)
+		{
+			const FTextMeshLOD& lod = mLODs[iLOD];
+			const FResultMeshData* meshes = Mesh.GetLODMeshes(iLOD);
+			unsigned meshIndices[3];
+			if (GatherSections(mGenerate, meshes, meshIndices) != lod.NumSections)
+				return false;
 
-		mNumSelection = 0;
+			for (unsigned iSection = 0; iSection < lod.NumSections; iSection++)
+			{
+				if (lod.Sections[iSection].MeshIndex != meshIndices[iSection] || meshes[meshIndices[iSection]].format != mFormat)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	//a mesh being rebuilt is drawn through the dynamic path until it is replaced
+	void SetRebuilding_RenderThread(bool bRebuilding)
+	{
+		check(IsInRenderingThread());
+		mDrawDynamic = mDynamicText || bRebuilding;
+	}
+
+	//replaces the mesh, reusing the buffers. see CanUpdateInPlace
+	void UpdateMesh_RenderThread(const TSharedPtr<FMeshResultFinal, ESPMode::ThreadSafe>& NewMesh)
+	{
+		check(IsInRenderingThread());
 
-		if (Component->bGenerateFronFace)
-			LGenSection(0);
-		if(Component->bGenerateBackFace)
-			LGenSection(1);
-		if(Component->bGenerateSide)
-			LGenSection(2);
+		mMesh = NewMesh;
+		UpdateLayout();
+		mVertexBuffer.Update_RenderThread(mLayout);
+		mIndexBuffer.Update_RenderThread(mLayout);
+		if (mInstanced)
+			mInstanceBuffer.Update_RenderThread(*mMesh);
+	}
+
+	//LOD of the dynamic path for a view. the static path gets its LOD from the renderer, which compares the same screen sizes
+	unsigned GetLODForView(const FSceneView& View) const
+	{
+		const float screenSize = ComputeBoundsScreenSize(GetBounds().Origin, GetBounds().SphereRadius, View);
+
+		//the coarsest LOD whose screen size still covers the view, the views don't share any state
+		unsigned lodIndex = 0;
+		while (lodIndex + 1 < mNumLODs && screenSize < mLODs[lodIndex + 1].ScreenSize)
+			lodIndex++;
+		return lodIndex;
 	}
 
 	virtual ~FText3DSceneProxy()
 	{
-		for (unsigned iSection = 0; iSection < mNumSelection; iSection++)
+		if (mHasBuffers)
 		{
-				mSections[iSection].VertexBuffer.ReleaseResource();
-				mSections[iSection].IndexBuffer.ReleaseResource();
-				mSections[iSection].VertexFactory.ReleaseResource();
+			mVertexBuffer.ReleaseResource();
+			mIndexBuffer.ReleaseResource();
+			if (mInstanced)
+			{
+				mInstanceBuffer.ReleaseResource();
+				mInstanceVertexFactory.ReleaseResource();
+			}
+			else
+			{
+				mVertexFactory.ReleaseResource();
+			}
+		}
+	}
+
+	//fills the mesh batch of a section, except the material
+	void SetupMeshBatch(const FTextMeshSection& sectionMesh, FMeshBatch& Mesh) const
+	{
+		FMeshBatchElement& BatchElement = Mesh.Elements[0];
+		BatchElement.IndexBuffer = &mIndexBuffer;
+
+		Mesh.VertexFactory = &mVertexFactory;
+		BatchElement.FirstIndex = sectionMesh.FirstIndex;
+		BatchElement.NumPrimitives = sectionMesh.NumIndices / 3;
+		BatchElement.BaseVertexIndex = sectionMesh.BaseVertex;
+		BatchElement.MinVertexIndex = 0;
+		BatchElement.MaxVertexIndex = sectionMesh.NumVertices - 1;
+
+		Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+		Mesh.Type = PT_TriangleList;
+		Mesh.DepthPriorityGroup = SDPG_World;
+	}
+
+	//fills the mesh batch of a glyph section, a single draw of all the instances of the glyph, except the material
+	void SetupInstanceBatch(const FTextMeshSection& sectionMesh, const FTextMeshGlyph& glyph, FMeshBatch& Mesh) const
+	{
+		SetupMeshBatch(sectionMesh, Mesh);
+		Mesh.VertexFactory = &mInstanceVertexFactory;
+
+		//a single run, the instance stream starts at the first instance of the glyph
+		FMeshBatchElement& BatchElement = Mesh.Elements[0];
+		BatchElement.bIsInstanceRuns = true;
+		BatchElement.InstanceRuns = const_cast<uint32*>(glyph.InstanceRun);
+		BatchElement.NumInstances = 1;
+	}
+
+	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override
+	{
+		//the batches are added even while the mesh is rebuilt, the view relevance hides them until the rebuild is done
+		if (mDynamicText || !mHasBuffers)
+			return;
+
+		for (unsigned iLOD = 0; iLOD < mNumLODs; iLOD++)
+		{
+			const FTextMeshLOD& lod = mLODs[iLOD];
+			for (unsigned iSection = 0; iSection < lod.NumSections; iSection++)
+			{
+				const FTextMeshSection& sectionMesh = lod.Sections[iSection];
+
+				FMeshBatch Mesh;
+				SetupMeshBatch(sectionMesh, Mesh);
+				Mesh.Elements[0].PrimitiveUniformBufferResource = &GetUniformBuffer();
+				Mesh.MaterialRenderProxy = sectionMesh.Material->GetRenderProxy(false);
+				Mesh.LODIndex = iLOD;
+				Mesh.CastShadow = true;
+
+				PDI->DrawMesh(Mesh, lod.ScreenSize);
+			}
+		}
+
+		for (const FTextMeshGlyph& glyph : mGlyphs)
+		{
+			for (unsigned iSection = 0; iSection < glyph.NumSections; iSection++)
+			{
+				const FTextMeshSection& sectionMesh = glyph.Sections[iSection];
+
+				FMeshBatch Mesh;
+				SetupInstanceBatch(sectionMesh, glyph, Mesh);
+				Mesh.Elements[0].PrimitiveUniformBufferResource = &GetUniformBuffer();
+				Mesh.MaterialRenderProxy = sectionMesh.Material->GetRenderProxy(false);
+				Mesh.LODIndex = 0;
+				Mesh.CastShadow = true;
+
+				PDI->DrawMesh(Mesh, FLT_MAX);
+			}
 		}
 	}
 
@@ -190,7 +728,7 @@ public:
 
 		if(0) // debug drawing
 		{
-			for (unsigned iSection = 0; iSection < mNumSelection; iSection++)
+			for (unsigned iSection = 0; iSection < 3; iSection++)
 			{
 				for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
 				{
@@ -198,10 +736,10 @@ public:
 					{
 						FPrimitiveDrawInterface* pdi = Collector.GetPDI(ViewIndex);
 
-						for (int32 iIndex = 0; iIndex < mMesh->mMeshes[iSection].indices.Num(); iIndex++)
+						for (int32 iIndex = 0; iIndex < mMesh->mMeshes[iSection].NumIndices(); iIndex++)
 						{
-							int32 vertexIndex = mMesh->mMeshes[iSection].indices[iIndex];
-							FVector vertexPos = mMesh->mMeshes[iSection].vertices[vertexIndex].Position;
+							int32 vertexIndex = mMesh->mMeshes[iSection].GetIndex(iIndex);
+							FVector vertexPos = mMesh->mMeshes[iSection].GetPosition(vertexIndex);
 							pdi->DrawPoint(GetLocalToWorld().TransformPosition(vertexPos), FLinearColor::Red, 1, SDPG_World);
 						}
 					}
@@ -209,41 +747,36 @@ public:
 			}
 		}
 
-		// Iterate over sections
-		for(unsigned iSection = 0; iSection < mNumSelection; iSection++)
+		// For each view.., the static path draws the sections when the mesh is not being rebuilt
+		for (int32 ViewIndex = 0; mDrawDynamic && mHasBuffers && ViewIndex < Views.Num(); ViewIndex++)
 		{
-			const FTextMeshSection& sectionMesh = mSections[iSection];
+			if (VisibilityMap & (1 << ViewIndex))
 			{
-				FMaterialRenderProxy* MaterialProxy = bWireframe ? WireframeMaterialInstance : sectionMesh.Material->GetRenderProxy(IsSelected());
+				const FSceneView* View = Views[ViewIndex];
+				if (mInstanced)
+				{
+					GetInstanceMeshElements(ViewIndex, bWireframe, WireframeMaterialInstance, Collector);
+					continue;
+				}
+				const FTextMeshLOD& lod = mLODs[GetLODForView(*View)];
 
-				// For each view..
-				for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+				// Iterate over sections
+				for (unsigned iSection = 0; iSection < lod.NumSections; iSection++)
 				{
-					if (VisibilityMap & (1 << ViewIndex))
-					{
-						const FSceneView* View = Views[ViewIndex];
-						// Draw the mesh.
-						FMeshBatch& Mesh = Collector.AllocateMesh();
-						FMeshBatchElement& BatchElement = Mesh.Elements[0];
-						BatchElement.IndexBuffer = &sectionMesh.IndexBuffer;
-
-						Mesh.bWireframe = bWireframe;
-						Mesh.VertexFactory = &sectionMesh.VertexFactory;
-						Mesh.MaterialRenderProxy = MaterialProxy;
-						BatchElement.PrimitiveUniformBuffer = this->GetUniformBuffer();
-						//CreatePrimitiveUniformBufferImmediate(GetLocalToWorld(), GetBounds(), GetLocalBounds(), true, UseEditorDepthTest());
-						BatchElement.FirstIndex = 0;
-						BatchElement.NumPrimitives = sectionMesh.IndexBuffer.mNumIndices / 3;
-						BatchElement.MinVertexIndex = 0;
-						BatchElement.MaxVertexIndex = sectionMesh.VertexBuffer.mNumVertices - 1;
-						
-						Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
-						Mesh.Type = PT_TriangleList;
-						Mesh.DepthPriorityGroup = SDPG_World;
-						Mesh.bCanApplyViewModeOverrides = false;
-
-						Collector.AddMesh(ViewIndex, Mesh);
-					}
+					const FTextMeshSection& sectionMesh = lod.Sections[iSection];
+					FMaterialRenderProxy* MaterialProxy = bWireframe ? WireframeMaterialInstance : sectionMesh.Material->GetRenderProxy(IsSelected());
+
+					// Draw the mesh.
+					FMeshBatch& Mesh = Collector.AllocateMesh();
+					SetupMeshBatch(sectionMesh, Mesh);
+
+					Mesh.bWireframe = bWireframe;
+					Mesh.MaterialRenderProxy = MaterialProxy;
+					Mesh.Elements[0].PrimitiveUniformBuffer = this->GetUniformBuffer();
+					//CreatePrimitiveUniformBufferImmediate(GetLocalToWorld(), GetBounds(), GetLocalBounds(), true, UseEditorDepthTest());
+					Mesh.bCanApplyViewModeOverrides = false;
+
+					Collector.AddMesh(ViewIndex, Mesh);
 				}
 			}
 		}
@@ -262,12 +795,37 @@ public:
 #endif
 	}
 
+	//adds the instances of every glyph for a view to the dynamic path
+	void GetInstanceMeshElements(int32 ViewIndex, bool bWireframe, FMaterialRenderProxy* WireframeMaterialInstance, FMeshElementCollector& Collector) const
+	{
+		for (const FTextMeshGlyph& glyph : mGlyphs)
+		{
+			for (unsigned iSection = 0; iSection < glyph.NumSections; iSection++)
+			{
+				const FTextMeshSection& sectionMesh = glyph.Sections[iSection];
+				FMaterialRenderProxy* MaterialProxy = bWireframe ? WireframeMaterialInstance : sectionMesh.Material->GetRenderProxy(IsSelected());
+
+				FMeshBatch& Mesh = Collector.AllocateMesh();
+				SetupInstanceBatch(sectionMesh, glyph, Mesh);
+
+				Mesh.bWireframe = bWireframe;
+				Mesh.MaterialRenderProxy = MaterialProxy;
+				Mesh.Elements[0].PrimitiveUniformBuffer = this->GetUniformBuffer();
+				Mesh.bCanApplyViewModeOverrides = false;
+
+				Collector.AddMesh(ViewIndex, Mesh);
+			}
+		}
+	}
+
 	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const
 	{
 		FPrimitiveViewRelevance Result;
 		Result.bDrawRelevance = IsShown(View);
 		Result.bShadowRelevance = IsShadowCast(View);
-		Result.bDynamicRelevance = true;
+		Result.bStaticRelevance = !mDrawDynamic;
+		//bounds are rendered by the dynamic path
+		Result.bDynamicRelevance = mDrawDynamic || View->Family->EngineShowFlags.Bounds;
 		Result.bRenderInMainPass = ShouldRenderInMainPass();
 		Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
 		Result.bRenderCustomDepth = ShouldRenderCustomDepth();
@@ -287,10 +845,24 @@ public:
 
 	uint32 GetAllocatedSize() const 
 	{
-		return(FPrimitiveSceneProxy::GetAllocatedSize());
+		return(FPrimitiveSceneProxy::GetAllocatedSize() + mGlyphs.GetAllocatedSize());
 	}
-	FTextMeshSection mSections[3];
-	unsigned mNumSelection = 0;
+	FTextMeshLOD mLODs[FMeshResultFinal::MaxLODs];
+	unsigned mNumLODs = 0;
+	bool mInstanced = false;
+	TArray<FTextMeshGlyph> mGlyphs;	//instanced text, drawn instead of the LODs
+	bool mGenerate[3];	//front, back, side
+	UMaterialInterface* mMaterials[3];
+	bool mHasBuffers = false;
+	EText3DVertexFormat mFormat = EText3DVertexFormat::FLOAT;
+	FText3DBufferLayout mLayout;
+	FText3DVertexBuffer mVertexBuffer;
+	FText3DIndexBuffer mIndexBuffer;
+	FText3DVertexFactory mVertexFactory;
+	FText3DInstanceBuffer mInstanceBuffer;	//instanced text only
+	FText3DInstancedVertexFactory mInstanceVertexFactory;
+	bool mDrawDynamic = true;
+	bool mDynamicText = false;
 	FMaterialRelevance	MaterialRelevance;
 	TSharedPtr<FMeshResultFinal, ESPMode::ThreadSafe> mMesh;
 };
@@ -300,4 +872,33 @@ FPrimitiveSceneProxy* UText3DComponent::CreateSceneProxy()
 	if (Text.IsEmpty() || Font == nullptr || !GeneratedMesh.IsValid())  return nullptr;
 
 	return new FText3DSceneProxy(this);
-}
\ No newline at end of file
+}
+
+bool UText3DComponent::UpdateSceneProxyMesh()
+{
+	FText3DSceneProxy* proxy = static_cast<FText3DSceneProxy*>(SceneProxy);
+	//the sections are only written by the proxy constructor, it's safe to read them here
+	if (proxy == nullptr || !GeneratedMesh.IsValid() || !proxy->CanUpdateInPlace(this, *GeneratedMesh))
+		return false;
+
+	TSharedPtr<FMeshResultFinal, ESPMode::ThreadSafe> newMesh = GeneratedMesh;
+	ENQUEUE_RENDER_COMMAND(FText3DUpdateMesh)(
+		[proxy, newMesh](FRHICommandListImmediate& RHICmdList) {
+			proxy->UpdateMesh_RenderThread(newMesh);
+		}
+	);
+	return true;
+}
+
+void UText3DComponent::SetSceneProxyRebuilding(bool bRebuilding)
+{
+	FText3DSceneProxy* proxy = static_cast<FText3DSceneProxy*>(SceneProxy);
+	if (proxy == nullptr)
+		return;
+
+	ENQUEUE_RENDER_COMMAND(FText3DSetRebuilding)(
+		[proxy, bRebuilding](FRHICommandListImmediate& RHICmdList) {
+			proxy->SetRebuilding_RenderThread(bRebuilding);
+		}
+	);
+}
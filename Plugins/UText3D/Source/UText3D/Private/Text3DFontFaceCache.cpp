@@ -0,0 +1,154 @@
+#include "Text3DFontFaceCache.h"
+#include "Text3D.h"
+#include "Text3DGlyphCache.h"
+#include "Text3DStats.h"
+#include "UObject/UObjectGlobals.h"
+
+#if WITH_FREETYPE && WITH_HARFBUZZ
+
+THIRD_PARTY_INCLUDES_START
+#include FT_MODULE_H
+THIRD_PARTY_INCLUDES_END
+
+FT_Library GetFreeTypeLib()
+{
+	struct FTLib
+	{
+		FT_Library Instance = nullptr;
+
+		FTLib()
+		{
+			FT_Error err = FT_Init_FreeType(&Instance);
+			if (err)
+			{
+				UE_LOG(Text3D, Error, TEXT("Failed to get free type library"));
+				return;
+			}
+			FT_Add_Default_Modules(Instance);
+		}
+		~FTLib()
+		{
+			FT_Done_Library(Instance);
+		}
+	};
+	static FTLib FTLibrary;
+	return FTLibrary.Instance;
+};
+
+FCriticalSection& GetFreeTypeLibLock()
+{
+	static FCriticalSection Lock;
+	return Lock;
+}
+
+FText3DFontFace::~FText3DFontFace()
+{
+	FScopeLock libLock(&GetFreeTypeLibLock());
+	if (mHBFont)
+		hb_font_destroy(mHBFont);
+	if (mFace)
+		FT_Done_Face(mFace);
+}
+
+FText3DFontFaceCache& FText3DFontFaceCache::Get()
+{
+	static FText3DFontFaceCache Instance;
+	return Instance;
+}
+
+void FText3DFontFaceCache::Startup()
+{
+	mGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FText3DFontFaceCache::OnPostGarbageCollect);
+}
+
+void FText3DFontFaceCache::Shutdown()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(mGCHandle);
+
+	FScopeLock lock(&mLock);
+	mFaces.Empty();
+	SET_DWORD_STAT(STAT_Text3D_CachedFaces, 0);
+}
+
+FText3DFontFacePtr FText3DFontFaceCache::Acquire(FObjectKey font, const FFontFaceDataConstRef& data)
+{
+	FScopeLock lock(&mLock);
+
+	if (FText3DFontFacePtr* found = mFaces.Find(font))
+	{
+		if ((*found)->mData.Get() == &data.Get())
+			return *found;
+
+		//font has been reimported, the old glyphs are not valid anymore
+		mFaces.Remove(font);
+		DEC_DWORD_STAT(STAT_Text3D_CachedFaces);
+		FText3DGlyphCache::Get().RemoveFont(font);
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_Text3D_FaceCreation);
+
+	FT_Library lib = GetFreeTypeLib();
+	if (lib == nullptr)
+	{
+		UE_LOG(Text3D, Error, TEXT("Failed to get true type library"));
+		return nullptr;
+	}
+
+	static uint32 NextSerial = 0;
+	FText3DFontFacePtr face = MakeShareable(new FText3DFontFace);
+	face->mData = data;
+	face->mSerial = ++NextSerial;
+
+	{
+		FScopeLock libLock(&GetFreeTypeLibLock());
+
+		//this is the content of a font file
+		const TArray<uint8>& fontData = data->GetData();
+		FT_Error error = FT_New_Memory_Face(lib, (const FT_Byte*)fontData.GetData(), (FT_Long)fontData.Num(), 0, &face->mFace);
+		if (error)
+		{
+			UE_LOG(Text3D, Error, TEXT("Failed to load face"));
+			face->mFace = nullptr;
+			return nullptr;
+		}
+
+		unsigned width = 64;
+		unsigned height = 64;
+		FT_Set_Char_Size(face->mFace, width << 6, height << 6, 96, 96);
+
+		face->mHBFont = hb_ft_font_create(face->mFace, nullptr);
+		if (face->mHBFont == nullptr)
+		{
+			UE_LOG(Text3D, Error, TEXT("Failed to create harfbuzz font"));
+			return nullptr;
+		}
+	}
+
+	mFaces.Add(font, face);
+	INC_DWORD_STAT(STAT_Text3D_CachedFaces);
+	return face;
+}
+
+void FText3DFontFaceCache::Remove(FObjectKey font)
+{
+	FScopeLock lock(&mLock);
+	if (mFaces.Remove(font))
+		DEC_DWORD_STAT(STAT_Text3D_CachedFaces);
+	FText3DGlyphCache::Get().RemoveFont(font);
+}
+
+void FText3DFontFaceCache::OnPostGarbageCollect()
+{
+	FScopeLock lock(&mLock);
+	for (auto iter = mFaces.CreateIterator(); iter; ++iter)
+	{
+		if (iter.Key().ResolveObjectPtr() == nullptr)
+		{
+			FText3DGlyphCache::Get().RemoveFont(iter.Key());
+			iter.RemoveCurrent();
+			DEC_DWORD_STAT(STAT_Text3D_CachedFaces);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Engine/FontFace.h"
+#include "Misc/ScopeLock.h"
+
+#if WITH_FREETYPE && WITH_HARFBUZZ
+
+THIRD_PARTY_INCLUDES_START
+#include "ft2build.h"
+#include FT_FREETYPE_H
+THIRD_PARTY_INCLUDES_END
+
+#include "Private/Fonts/FontCacheHarfBuzz.h"
+
+//a FreeType face and its HarfBuzz font created from a UFontFace
+struct FText3DFontFace
+{
+	//the font file content, FT_New_Memory_Face doesn't copy it so we keep it alive
+	TSharedPtr<const FFontFaceData, ESPMode::ThreadSafe> mData;
+	FT_Face mFace = nullptr;
+	hb_font_t* mHBFont = nullptr;
+	//unique for every face created, a reimported font gets a new face and so a new serial
+	uint32 mSerial = 0;
+	//FT_Face and hb_font_t are not thread safe, hold this while shaping or loading glyphs
+	FCriticalSection mLock;
+
+	~FText3DFontFace();
+};
+
+typedef TSharedPtr<FText3DFontFace, ESPMode::ThreadSafe> FText3DFontFacePtr;
+
+//keeps one face per UFontFace alive between the mesh generations, safe to use from any thread.
+//faces are reference counted, a face removed from the cache lives until the last build using it is done.
+class FText3DFontFaceCache
+{
+public:
+	static FText3DFontFaceCache& Get();
+
+	void Startup();
+	void Shutdown();
+
+	//returns the face of the font, creates it if it's not cached or if the font data has changed. returns null on failure
+	FText3DFontFacePtr Acquire(FObjectKey font, const FFontFaceDataConstRef& data);
+	//removes the face of the font and its cached glyphs
+	void Remove(FObjectKey font);
+
+private:
+	//removes the faces whose UFontFace has been garbage collected
+	void OnPostGarbageCollect();
+
+	FCriticalSection mLock;
+	TMap<FObjectKey, FText3DFontFacePtr> mFaces;
+	FDelegateHandle mGCHandle;
+};
+
+FT_Library GetFreeTypeLib();
+//creating and destroying faces of the library must be serialized, the last reference to a face may be released on any thread
+FCriticalSection& GetFreeTypeLibLock();
+
+#endif
@@ -0,0 +1,117 @@
+#include "Text3DGlyphCache.h"
+#include "Text3D.h"
+#include "Text3DStats.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarText3DGlyphCacheMB(
+	TEXT("Text3D.GlyphCacheMB"),
+	64,
+	TEXT("Memory budget of the Text3D glyph cache in MB, the least recently used glyphs are evicted beyond it. 0 doesn't limit the cache."),
+	ECVF_Default);
+
+FText3DGlyphCache& FText3DGlyphCache::Get()
+{
+	static FText3DGlyphCache Instance;
+	return Instance;
+}
+
+FText3DGlyphMeshPtr FText3DGlyphCache::Find(const FText3DGlyphKey& key)
+{
+	FScopeLock lock(&mLock);
+	if (FEntry* found = mGlyphs.Find(key))
+	{
+		mHits.Increment();
+		INC_DWORD_STAT(STAT_Text3D_GlyphCacheHits);
+		found->mLastUse = ++mUseCounter;
+		return found->mMesh;
+	}
+	mMisses.Increment();
+	INC_DWORD_STAT(STAT_Text3D_GlyphCacheMisses);
+	return nullptr;
+}
+
+FText3DGlyphMeshPtr FText3DGlyphCache::Add(const FText3DGlyphKey& key, FText3DGlyphMesh* mesh)
+{
+	FText3DGlyphMeshPtr newMesh = MakeShareable(mesh);
+
+	FScopeLock lock(&mLock);
+	if (FEntry* found = mGlyphs.Find(key))
+	{
+		found->mLastUse = ++mUseCounter;
+		return found->mMesh;
+	}
+
+	FEntry& entry = mGlyphs.Add(key);
+	entry.mMesh = newMesh;
+	entry.mSize = newMesh->GetAllocatedSize();
+	entry.mLastUse = ++mUseCounter;
+	mTotalSize += entry.mSize;
+	INC_DWORD_STAT(STAT_Text3D_CachedGlyphs);
+	INC_MEMORY_STAT_BY(STAT_Text3D_GlyphCacheMemory, entry.mSize);
+
+	Trim();
+	return newMesh;
+}
+
+void FText3DGlyphCache::Trim()
+{
+	const SIZE_T budget = (SIZE_T)FMath::Max(CVarText3DGlyphCacheMB.GetValueOnAnyThread(), 0) * 1024 * 1024;
+	if (budget == 0 || mTotalSize <= budget)
+		return;
+
+	//evict down to 7/8 of the budget so that the next additions don't sort the cache again right away
+	const SIZE_T target = budget - budget / 8;
+
+	TArray<TPair<uint64, FText3DGlyphKey>> byUse;
+	byUse.Reserve(mGlyphs.Num());
+	for (const auto& pair : mGlyphs)
+		byUse.Emplace(pair.Value.mLastUse, pair.Key);
+	byUse.Sort([](const TPair<uint64, FText3DGlyphKey>& a, const TPair<uint64, FText3DGlyphKey>& b) { return a.Key < b.Key; });
+
+	int32 numEvicted = 0;
+	//the last one is the glyph just added, it is kept even if it alone exceeds the budget
+	for (int32 i = 0; i < byUse.Num() - 1 && mTotalSize > target; i++)
+	{
+		FEntry entry;
+		mGlyphs.RemoveAndCopyValue(byUse[i].Value, entry);
+		mTotalSize -= entry.mSize;
+		DEC_DWORD_STAT(STAT_Text3D_CachedGlyphs);
+		DEC_MEMORY_STAT_BY(STAT_Text3D_GlyphCacheMemory, entry.mSize);
+		numEvicted++;
+	}
+	UE_LOG(Text3D, Verbose, TEXT("Glyph cache over budget, evicted %d glyphs, %d left"), numEvicted, mGlyphs.Num());
+}
+
+void FText3DGlyphCache::RemoveFont(FObjectKey font)
+{
+	FScopeLock lock(&mLock);
+	for (auto iter = mGlyphs.CreateIterator(); iter; ++iter)
+	{
+		if (iter.Key().mFont == font)
+		{
+			mTotalSize -= iter.Value().mSize;
+			DEC_DWORD_STAT(STAT_Text3D_CachedGlyphs);
+			DEC_MEMORY_STAT_BY(STAT_Text3D_GlyphCacheMemory, iter.Value().mSize);
+			iter.RemoveCurrent();
+		}
+	}
+}
+
+void FText3DGlyphCache::Empty()
+{
+	FScopeLock lock(&mLock);
+	UE_LOG(Text3D, Log, TEXT("Glyph cache emptied, %d glyphs, %d hits, %d misses"), mGlyphs.Num(), mHits.GetValue(), mMisses.GetValue());
+	SET_DWORD_STAT(STAT_Text3D_CachedGlyphs, 0);
+	SET_MEMORY_STAT(STAT_Text3D_GlyphCacheMemory, 0);
+	mGlyphs.Empty();
+	mTotalSize = 0;
+	mUseCounter = 0;
+	mHits.Reset();
+	mMisses.Reset();
+}
+
+int32 FText3DGlyphCache::GetNumGlyphs() const
+{
+	FScopeLock lock(&mLock);
+	return mGlyphs.Num();
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Text3DComponent.h"
+#include "UObject/ObjectKey.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/ScopeLock.h"
+
+//identifies a triangulated glyph, everything that changes the glyph local geometry must be here
+struct FText3DGlyphKey
+{
+	FObjectKey mFont;
+	uint32 mFaceSerial = 0;	//FText3DFontFace::mSerial, so builds still running with the face of a reimported font can't add to the new one
+	uint32 mGlyphIndex = 0;
+	int mBezierSteps = 0;
+	float mBezierTolerance = 0;
+	int mMaxCurveSteps = 0;
+	float mExtrude = 0;
+	float mSmoothingAngle = 0;
+	uint8 mFlags = 0;	//bit 0 front, bit 1 back, bit 2 side
+
+	bool operator == (const FText3DGlyphKey& other) const
+	{
+		return mFont == other.mFont && mFaceSerial == other.mFaceSerial && mGlyphIndex == other.mGlyphIndex && mBezierSteps == other.mBezierSteps
+			&& mBezierTolerance == other.mBezierTolerance && mMaxCurveSteps == other.mMaxCurveSteps && mExtrude == other.mExtrude && mSmoothingAngle == other.mSmoothingAngle && mFlags == other.mFlags;
+	}
+	friend uint32 GetTypeHash(const FText3DGlyphKey& key)
+	{
+		uint32 hash = GetTypeHash(key.mFont);
+		hash = HashCombine(hash, key.mFaceSerial);
+		hash = HashCombine(hash, key.mGlyphIndex);
+		hash = HashCombine(hash, (uint32)key.mBezierSteps);
+		hash = HashCombine(hash, GetTypeHash(key.mBezierTolerance));
+		hash = HashCombine(hash, (uint32)key.mMaxCurveSteps);
+		hash = HashCombine(hash, GetTypeHash(key.mExtrude));
+		hash = HashCombine(hash, GetTypeHash(key.mSmoothingAngle));
+		return HashCombine(hash, key.mFlags);
+	}
+};
+
+//geometry of a single glyph in glyph local space (origin at the pen position)
+struct FText3DGlyphMesh
+{
+	//indexed triangulation of the front face at z 0, the back face is the same at the depth with the opposite winding
+	TArray<FVector2D> mFaceVertices;
+	TArray<int32> mFaceIndices;
+	//indexed side walls
+	TArray<FTextMeshVertex> mSideVertices;
+	TArray<int32> mSideIndices;
+	FBox mBound = FBox(ForceInit);
+
+	void CalcBound(bool front, bool back, float extrude)
+	{
+		mBound.Init();
+		for (const FVector2D& vertex : mFaceVertices)
+		{
+			if (front)
+				mBound += FVector(vertex, 0);
+			if (back)
+				mBound += FVector(vertex, extrude);
+		}
+		for (const FTextMeshVertex& vertex : mSideVertices)
+			mBound += vertex.Position;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return mFaceVertices.GetAllocatedSize() + mFaceIndices.GetAllocatedSize() + mSideVertices.GetAllocatedSize() + mSideIndices.GetAllocatedSize();
+	}
+};
+
+typedef TSharedPtr<const FText3DGlyphMesh, ESPMode::ThreadSafe> FText3DGlyphMeshPtr;
+
+//process wide cache of triangulated glyphs shared by all the UText3DComponents, safe to use from any thread.
+//once its glyphs take more than Text3D.GlyphCacheMB the least recently used ones are evicted,
+//builds and line caches that still hold an evicted glyph keep it alive until they release it
+class FText3DGlyphCache
+{
+public:
+	static FText3DGlyphCache& Get();
+
+	//returns null if the glyph is not cached yet
+	FText3DGlyphMeshPtr Find(const FText3DGlyphKey& key);
+	//adds a glyph, if another thread has added the same glyph in the meantime that one is returned
+	FText3DGlyphMeshPtr Add(const FText3DGlyphKey& key, FText3DGlyphMesh* mesh);
+	//removes every glyph of the specified font
+	void RemoveFont(FObjectKey font);
+	void Empty();
+
+	int32 GetNumGlyphs() const;
+	int32 GetHitCount() const { return mHits.GetValue(); }
+	int32 GetMissCount() const { return mMisses.GetValue(); }
+
+private:
+	struct FEntry
+	{
+		FText3DGlyphMeshPtr mMesh;
+		SIZE_T mSize = 0;
+		uint64 mLastUse = 0;
+	};
+
+	//evicts the least recently used glyphs until the cache fits in its budget, mLock must be held
+	void Trim();
+
+	mutable FCriticalSection mLock;
+	TMap<FText3DGlyphKey, FEntry> mGlyphs;
+	SIZE_T mTotalSize = 0;
+	uint64 mUseCounter = 0;
+	FThreadSafeCounter mHits;
+	FThreadSafeCounter mMisses;
+};
@@ -0,0 +1,42 @@
+#include "Text3DLineCache.h"
+#include "Text3DStats.h"
+
+void FText3DLineCache::BeginBuild(const FText3DLineSettings& settings)
+{
+	if (settings != mSettings)
+	{
+		mSettings = settings;
+		mLines.Empty();
+		mUsedLines.Empty();
+		return;
+	}
+
+	//a cancelled build leaves its lines here, they are still valid
+	mLines.Append(MoveTemp(mUsedLines));
+	mUsedLines.Reset();
+}
+
+void FText3DLineCache::EndBuild()
+{
+	mLines = MoveTemp(mUsedLines);
+	mUsedLines.Reset();
+}
+
+FText3DLinePtr FText3DLineCache::Find(const FString& text)
+{
+	if (const FText3DLinePtr* found = mUsedLines.Find(text))
+		return *found;
+
+	const FText3DLinePtr* found = mLines.Find(text);
+	if (found == nullptr)
+		return nullptr;
+
+	INC_DWORD_STAT(STAT_Text3D_ReusedLines);
+	mUsedLines.Add(text, *found);
+	return *found;
+}
+
+void FText3DLineCache::Add(const FString& text, const FText3DLinePtr& line)
+{
+	mUsedLines.Add(text, line);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Text3DComponent.h"
+#include "Text3DGlyphCache.h"
+
+//////////////////////////////////////////////////////////////////////////
+//a shaped glyph waiting for its mesh
+struct FGlyphPlacement
+{
+	uint32 mGlyphIndex;
+	FVector2D mOffset;
+};
+
+//a shaped and placed line of text in line local space, the pen starts at the origin
+struct FText3DLine
+{
+	TArray<FGlyphPlacement> mPlacements;
+	FResultMeshData mMeshes[3];	//front, back, side, neither aligned nor transformed
+	FBox mBound = FBox(ForceInit);
+};
+
+typedef TSharedPtr<FText3DLine, ESPMode::ThreadSafe> FText3DLinePtr;
+
+//everything that changes the shaping and geometry of a line. the glyph key identifies the font face,
+//so a reimported font never matches, and the default settings match no build
+struct FText3DLineSettings
+{
+	FText3DGlyphKey mGlyphKey;	//mGlyphIndex is unused
+	char mScript[8] = {};
+
+	bool operator == (const FText3DLineSettings& other) const
+	{
+		return mGlyphKey == other.mGlyphKey && FMemory::Memcmp(mScript, other.mScript, sizeof(mScript)) == 0;
+	}
+	bool operator != (const FText3DLineSettings& other) const { return !(*this == other); }
+};
+
+//the lines of the previous build of a component, keyed by their text. a build reuses the lines that haven't changed
+//and only shapes and places the others. a component runs one build at a time, so the cache isn't locked
+class FText3DLineCache
+{
+public:
+	//the lines depend on the font and geometry settings, the cache is emptied when they change
+	void BeginBuild(const FText3DLineSettings& settings);
+	//ends a build that has not been cancelled, the lines it didn't use are dropped
+	void EndBuild();
+
+	//returns null if the line is not cached. a found line is kept for the next build
+	FText3DLinePtr Find(const FString& text);
+	void Add(const FString& text, const FText3DLinePtr& line);
+
+private:
+	FText3DLineSettings mSettings;
+	TMap<FString, FText3DLinePtr> mLines;
+	TMap<FString, FText3DLinePtr> mUsedLines;	//lines of the running build
+};
+
+typedef TSharedPtr<FText3DLineCache, ESPMode::ThreadSafe> FText3DLineCachePtr;
@@ -0,0 +1,861 @@
+#pragma once
+
+#include "Text3DComponent.h"
+#include "Text3D.h"
+#include "Engine/FontFace.h"
+#include "Async/ParallelFor.h"
+#include "Internationalization/Text.h"
+#include "RHI.h"
+
+#include "Vectoriser.h"
+#include "Text3DGlyphCache.h"
+#include "Text3DFontFaceCache.h"
+#include "Text3DLineCache.h"
+#include "Text3DStats.h"
+
+#include "poly2tri/poly2tri.h"
+
+#if WITH_FREETYPE && WITH_HARFBUZZ
+
+//converts a contour of the vectoriser to a p2t polyline, the points are allocated in the p2t::Arena
+std::vector<p2t::Point*> UTriangulateContour(const Vectoriser *vectoriser, int c, FVector2D offset);
+
+//a line of the text being built
+struct FShapedLine
+{
+	FString mText;
+	FVector2D mOrigin;	//pen position at the start of the line
+	int32 mFirstPlacement = 0;
+	int32 mNumPlacements = 0;
+	FText3DLinePtr mLine;	//shaping and geometry in line local space, null without a line cache or when shaping failed
+	bool mReused = false;	//mLine comes from the previous build and has its geometry
+};
+
+//curve settings of a level of detail, see FTextShaper::CalcLODCurves
+struct FText3DLODCurves
+{
+	int mSteps;
+	float mTolerance;
+	int mMaxSteps;	//only used with a tolerance
+
+	//true if both give the same segments
+	bool operator == (const FText3DLODCurves& other) const
+	{
+		return mSteps == other.mSteps && mTolerance == other.mTolerance && (mTolerance <= 0 || mMaxSteps == other.mMaxSteps);
+	}
+};
+
+//tolerance of LOD 1 when the text has none, and the largest tolerance of any LOD, as fractions of the em size
+static const float GText3DFirstLODTolerance = 1.0f / 256.0f;
+static const float GText3DMaxLODTolerance = 1.0f / 16.0f;
+
+//////////////////////////////////////////////////////////////////////////
+struct FTextShaper
+{
+
+	FText3DFontFacePtr mFace;
+	TSharedPtr<const FFontFaceData, ESPMode::ThreadSafe> mFontData;
+	FObjectKey mFontKey;
+	FString mText;
+	hb_language_t mTextLanguage;
+	int mBezierSteps;
+	float mBezierTolerance;
+	int mMaxCurveSteps = 64;	//most segments a curve gets from mBezierTolerance, lowered by the LODs
+	float mExtrude;
+	float mSmoothingAngle;
+	bool mGenerateSide;
+	bool mGenerateFontFace;
+	bool mGenerateBackFace;
+	EText3DVAlign mVTA;
+	EText3DHAlign mHTA;
+	FTransform mTransform;
+	float mLineSpace;
+	FResultMeshData mMeshes[3];	//front, back, side, indexed while the glyphs are placed
+	TArray<FGlyphPlacement> mPlacements;
+	TArray<FShapedLine> mLines;
+	FText3DLineCachePtr mLineCache;	//optional, see FText3DLineCache
+	bool mReuseLines = true;	//false while the LODs are placed, the cached geometry is LOD 0
+	FBox mTextBound = FBox(ForceInit);	//bounds of the placed glyphs
+	bool mParallelTriangulation;
+	int mParallelMinGlyphs;
+	EText3DVertexFormat mVertexFormat;
+	int mNumLODs;
+	bool mInstanceGlyphs;
+	TArray<FMeshResultGlyph> mGlyphs;	//instanced text, see PlaceInstances
+	const TMap<uint32, FText3DGlyphMeshPtr>* mResolvedGlyphs = nullptr;	//optional, meshes resolved for a whole batch of shapers
+	FMatrix mPositionMatrix;	//alignment and transform of the vertices, see TransformMesh
+	FMatrix mNormalMatrix;
+	char mScript[8] = {};
+	TSharedPtr<FText3DBuildToken, ESPMode::ThreadSafe> mBuildToken;
+	int32 mGeneration = 0;
+
+	FTextShaper(UText3DComponent* pComponent)
+	{
+		this->mFontKey = FObjectKey(pComponent->Font);
+		this->mFontData = pComponent->Font->FontFaceData;
+		this->mBezierSteps = pComponent->BezierStep;
+		this->mBezierTolerance = pComponent->BezierTolerance;
+		this->mExtrude = pComponent->Depth;
+		this->mSmoothingAngle = pComponent->SideSmoothingAngle;
+		this->mText = pComponent->Text;
+		this->mGenerateFontFace = pComponent->bGenerateFronFace;
+		this->mGenerateBackFace = pComponent->bGenerateBackFace;
+		this->mGenerateSide = pComponent->bGenerateSide;
+		this->mVTA = pComponent->VerticalAlignment;
+		this->mHTA = pComponent->HorizontalAlignment;
+		this->mTransform = pComponent->Transform;
+		this->mLineSpace = pComponent->LineSpace;
+		this->mParallelTriangulation = pComponent->bParallelTriangulation;
+		this->mParallelMinGlyphs = pComponent->ParallelMinGlyphs;
+		this->mVertexFormat = pComponent->VertexFormat;
+		//instanced glyphs are drawn with hardware instancing, the text is built as a whole without it
+		this->mInstanceGlyphs = pComponent->bInstanceGlyphs && GRHISupportsInstancing;
+		this->mNumLODs = mInstanceGlyphs ? 1 : FMath::Clamp(pComponent->NumLODs, 1, FMeshResultFinal::MaxLODs);
+		this->mTextLanguage = hb_language_get_default();
+
+		for (int i = 0; i < 8; i++)
+			this->mScript[i] = pComponent->Script.IsValidIndex(i) ? (char)(pComponent->Script[i]) : (char)0;
+
+	}
+	//triangulates the outline of a glyph in glyph local space and computes its bounds
+	void TriangulateGlyph_P2T(const Vectoriser& vectoriser, FText3DGlyphMesh& outMesh)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Triangulate);
+
+		if (1)
+		{
+			//holes of each outer contour, every hole belongs to the innermost outer contour around it
+			TArray<TArray<int32>> contourHoles;
+			contourHoles.SetNum((int32)vectoriser.ContourCount());
+			for (size_t c = 0; c < vectoriser.ContourCount(); ++c)
+			{
+				const int parent = vectoriser.GetParent(c);
+				if (parent >= 0 && !vectoriser.GetContour(c)->GetDirection() && vectoriser.GetContour(parent)->GetDirection())
+					contourHoles[parent].Add((int32)c);
+			}
+
+			for (size_t c = 0; c < vectoriser.ContourCount(); ++c)
+			{
+				const Contour* contour = vectoriser.GetContour(c);
+
+				//FVector vOffset = FVector(xx, yy, 0);
+
+				if (mGenerateSide)
+					GenSideWall(*contour, outMesh);
+				if (mGenerateBackFace || mGenerateFontFace)
+				{
+					if (contour->GetDirection())
+					{
+						{
+							//everything the CDT allocates is released at the end of this scope
+							p2t::ArenaScope arenaScope;
+
+							//the sweep can't handle a failed allocation, so it gets all its memory up front
+							size_t numPoints = contour->PointCount();
+							for (int32 cm : contourHoles[(int32)c])
+								numPoints += vectoriser.GetContour(cm)->PointCount();
+							if (!p2t::Arena::Get().Reserve(p2t::CDT::ArenaSize(numPoints)))
+							{
+								UE_LOG(Text3D, Error, TEXT("out of memory triangulating glyph contour"));
+								continue;
+							}
+
+							std::vector<p2t::Point*> polyline = UTriangulateContour(&vectoriser, c, FVector2D::ZeroVector);
+							if(polyline.size() < 3)
+								continue;
+
+							p2t::CDT cdt = p2t::CDT(polyline);
+
+							for (int32 cm : contourHoles[(int32)c]) 
+							{
+								std::vector<p2t::Point*> pl = UTriangulateContour(&vectoriser, cm, FVector2D::ZeroVector);
+								
+								if(pl.size() < 3)
+									continue;
+
+								cdt.AddHole(pl);
+							}
+
+							//self touching contours and repeated points are not supported by the sweep
+							if (!cdt.Triangulate())
+							{
+								UE_LOG(Text3D, Warning, TEXT("glyph contour can't be triangulated, its faces are skipped"));
+								continue;
+							}
+							std::vector<p2t::Triangle*> ts = cdt.GetTriangles();
+
+							//every point of the CDT is a vertex of the face, triangles refer to it by identity
+							TMap<const p2t::Point*, int32> pointIndices;
+							pointIndices.Reserve(ts.size() + 2);
+							outMesh.mFaceIndices.Reserve(outMesh.mFaceIndices.Num() + ts.size() * 3);
+
+							for (int i = 0; i < ts.size(); i++) 
+							{
+								p2t::Triangle* ot = ts[i];
+								for (int iPoint = 0; iPoint < 3; iPoint++)
+								{
+									const p2t::Point* point = ot->GetPoint(iPoint);
+									const int32* found = pointIndices.Find(point);
+									int32 index = found ? *found : INDEX_NONE;
+									if (index == INDEX_NONE)
+									{
+										index = outMesh.mFaceVertices.Add(FVector2D(point->x, point->y));
+										pointIndices.Add(point, index);
+									}
+									outMesh.mFaceIndices.Add(index);
+								}
+							}
+						}
+
+					}
+				}
+
+			}
+		}
+
+		outMesh.CalcBound(mGenerateFontFace, mGenerateBackFace, mExtrude);
+	}
+	//true if the component has requested a newer build or has been destroyed
+	bool IsCancelled() const
+	{
+		return mBuildToken.IsValid() && mBuildToken->mGeneration.GetValue() != mGeneration;
+	}
+	//returns the cached glyph mesh, triangulates and caches it on a miss. returns null on failure
+	FText3DGlyphMeshPtr GetGlyphMesh(uint32 glyphIndex)
+	{
+		const FText3DGlyphKey key = MakeGlyphKey(glyphIndex);
+
+		FText3DGlyphMeshPtr glyphMesh = FText3DGlyphCache::Get().Find(key);
+		if (glyphMesh.IsValid())
+			return glyphMesh;
+
+		TUniquePtr<Vectoriser> vectoriser = VectoriseGlyph(glyphIndex);
+		if (!vectoriser.IsValid())
+			return nullptr;
+
+		FText3DGlyphMesh* newMesh = new FText3DGlyphMesh;
+		TriangulateGlyph_P2T(*vectoriser, *newMesh);
+		return FText3DGlyphCache::Get().Add(key, newMesh);
+	}
+	FText3DGlyphKey MakeGlyphKey(uint32 glyphIndex) const
+	{
+		FText3DGlyphKey key;
+		key.mFont = mFontKey;
+		key.mFaceSerial = mFace.IsValid() ? mFace->mSerial : 0;
+		key.mGlyphIndex = glyphIndex;
+		key.mBezierSteps = mBezierSteps;
+		key.mBezierTolerance = mBezierTolerance;
+		key.mMaxCurveSteps = mBezierTolerance > 0 ? mMaxCurveSteps : 0;
+		key.mExtrude = mExtrude;
+		key.mSmoothingAngle = mGenerateSide ? mSmoothingAngle : 0;
+		key.mFlags = (mGenerateFontFace ? 1 : 0) | (mGenerateBackFace ? 2 : 0) | (mGenerateSide ? 4 : 0);
+		return key;
+	}
+	//settings that change the shaping and geometry of a line, see FText3DLineCache
+	FText3DLineSettings MakeLineSettings() const
+	{
+		FText3DLineSettings settings;
+		settings.mGlyphKey = MakeGlyphKey(0);
+		FMemory::Memcpy(settings.mScript, mScript, sizeof(mScript));
+		return settings;
+	}
+	//loads the glyph and flattens its outline into contours. returns null on failure
+	TUniquePtr<Vectoriser> VectoriseGlyph(uint32 glyphIndex)
+	{
+		FScopeLock faceLock(&mFace->mLock);
+
+		if (FT_Load_Glyph(mFace->mFace, glyphIndex, FT_LOAD_DEFAULT))
+		{
+			UE_LOG(Text3D, Error, TEXT("FT_Load_Glyph failed"));
+			return nullptr;
+		}
+
+		auto glyph = mFace->mFace->glyph;
+		if (glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+		{
+			UE_LOG(Text3D, Error, TEXT("glyph must be FT_GLYPH_FORMAT_OUTLINE"));
+			return nullptr;
+		}
+
+		//the contours copy the outline, so the triangulation doesn't need the face anymore
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Vectorise);
+		return MakeUnique<Vectoriser>(glyph, (unsigned short)mBezierSteps, mBezierTolerance * 64.0, (unsigned short)mMaxCurveSteps);
+	}
+	//resolves the meshes of mPlacements and appends them in placement order, so the result doesn't depend on threading.
+	//the lines reused from the line cache copy their geometry instead
+	void PlaceGlyphs()
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_PlaceGlyphs);
+		INC_DWORD_STAT_BY(STAT_Text3D_Glyphs, mPlacements.Num());
+
+		const bool bReuseLines = mReuseLines && !mInstanceGlyphs && mLineCache.IsValid();
+
+		//distinct glyphs in order of first appearance
+		TArray<uint32> uniqueGlyphs;
+		TMap<uint32, int32> glyphSlots;
+		for (const FShapedLine& line : mLines)
+		{
+			if (bReuseLines && line.mReused)
+				continue;
+
+			for (int32 iPlacement = line.mFirstPlacement; iPlacement < line.mFirstPlacement + line.mNumPlacements; iPlacement++)
+			{
+				const FGlyphPlacement& placement = mPlacements[iPlacement];
+				if (!glyphSlots.Contains(placement.mGlyphIndex))
+					glyphSlots.Add(placement.mGlyphIndex, uniqueGlyphs.Add(placement.mGlyphIndex));
+			}
+		}
+
+		TArray<FText3DGlyphMeshPtr> glyphMeshes;
+		glyphMeshes.SetNum(uniqueGlyphs.Num());
+
+		auto LResolveGlyph = [&](int32 iGlyph)
+		{
+			const FText3DGlyphMeshPtr* resolved = mResolvedGlyphs ? mResolvedGlyphs->Find(uniqueGlyphs[iGlyph]) : nullptr;
+			if (resolved)
+				glyphMeshes[iGlyph] = *resolved;
+			else if (!IsCancelled())
+				glyphMeshes[iGlyph] = GetGlyphMesh(uniqueGlyphs[iGlyph]);
+		};
+
+		if (mParallelTriangulation && uniqueGlyphs.Num() >= mParallelMinGlyphs)
+		{
+			ParallelFor(uniqueGlyphs.Num(), LResolveGlyph);
+		}
+		else
+		{
+			for (int32 iGlyph = 0; iGlyph < uniqueGlyphs.Num(); iGlyph++)
+				LResolveGlyph(iGlyph);
+		}
+
+		if (mInstanceGlyphs)
+		{
+			PlaceInstances(glyphMeshes, glyphSlots);
+			return;
+		}
+
+		for (const FShapedLine& line : mLines)
+		{
+			if (bReuseLines && line.mReused)
+			{
+				AppendLine(*line.mLine, line.mOrigin);
+				continue;
+			}
+
+			int32 firstVertex[3];
+			int32 firstIndex[3];
+			for (int iMesh = 0; iMesh < 3; iMesh++)
+			{
+				firstVertex[iMesh] = mMeshes[iMesh].vertices.Num();
+				firstIndex[iMesh] = mMeshes[iMesh].indices.Num();
+			}
+
+			FBox lineBound(ForceInit);
+			for (int32 iPlacement = line.mFirstPlacement; iPlacement < line.mFirstPlacement + line.mNumPlacements; iPlacement++)
+			{
+				const FGlyphPlacement& placement = mPlacements[iPlacement];
+				const FText3DGlyphMeshPtr& glyphMesh = glyphMeshes[glyphSlots[placement.mGlyphIndex]];
+				if (!glyphMesh.IsValid())
+					return;
+
+				PlaceGlyph(*glyphMesh, placement.mOffset);
+				lineBound += glyphMesh->mBound.ShiftBy(FVector(placement.mOffset - line.mOrigin, 0));
+			}
+
+			if (bReuseLines && line.mLine.IsValid())
+				CacheLine(line, firstVertex, firstIndex, lineBound);
+		}
+	}
+	//appends the geometry of a cached line at the specified pen position
+	void AppendLine(const FText3DLine& line, FVector2D origin)
+	{
+		const FVector vOffset = FVector(origin, 0);
+		mTextBound += line.mBound.ShiftBy(vOffset);
+
+		for (int iMesh = 0; iMesh < 3; iMesh++)
+		{
+			const FResultMeshData& src = line.mMeshes[iMesh];
+			FResultMeshData& dst = mMeshes[iMesh];
+			const int32 baseVertex = dst.vertices.Num();
+
+			dst.vertices.Append(src.vertices);
+			for (int32 iVertex = baseVertex; iVertex < dst.vertices.Num(); iVertex++)
+				dst.vertices[iVertex].Position += vOffset;
+
+			dst.indices.Reserve(dst.indices.Num() + src.indices.Num());
+			for (int32 index : src.indices)
+				dst.indices.Add(baseVertex + index);
+		}
+	}
+	//copies the geometry just placed for a line into its FText3DLine in line local space and caches it
+	void CacheLine(const FShapedLine& line, const int32 firstVertex[3], const int32 firstIndex[3], const FBox& lineBound)
+	{
+		const FVector vOffset = FVector(line.mOrigin, 0);
+		FText3DLine& cached = *line.mLine;
+		cached.mBound = lineBound;
+
+		for (int iMesh = 0; iMesh < 3; iMesh++)
+		{
+			const FResultMeshData& src = mMeshes[iMesh];
+			FResultMeshData& dst = cached.mMeshes[iMesh];
+
+			dst.vertices.Reset(src.vertices.Num() - firstVertex[iMesh]);
+			for (int32 iVertex = firstVertex[iMesh]; iVertex < src.vertices.Num(); iVertex++)
+			{
+				FTextMeshVertex& vertex = dst.vertices[dst.vertices.Add(src.vertices[iVertex])];
+				vertex.Position -= vOffset;
+			}
+
+			dst.indices.Reset(src.indices.Num() - firstIndex[iMesh]);
+			for (int32 iIndex = firstIndex[iMesh]; iIndex < src.indices.Num(); iIndex++)
+				dst.indices.Add(src.indices[iIndex] - firstVertex[iMesh]);
+		}
+
+		mLineCache->Add(line.mText, line.mLine);
+	}
+	//builds every distinct glyph once at the origin, the placements become its offsets
+	void PlaceInstances(const TArray<FText3DGlyphMeshPtr>& glyphMeshes, const TMap<uint32, int32>& glyphSlots)
+	{
+		for (const FText3DGlyphMeshPtr& glyphMesh : glyphMeshes)
+		{
+			if (!glyphMesh.IsValid())
+				return;
+
+			PlaceGlyph(*glyphMesh, FVector2D(0, 0));
+			TakeMeshes(mGlyphs[mGlyphs.AddDefaulted()].mMeshes);
+		}
+
+		mTextBound.Init();
+		for (const FGlyphPlacement& placement : mPlacements)
+		{
+			const int32 slot = glyphSlots[placement.mGlyphIndex];
+			const FVector vOffset = FVector(placement.mOffset, 0);
+			mTextBound += glyphMeshes[slot]->mBound.ShiftBy(vOffset);
+			mGlyphs[slot].mOffsets.Add(vOffset);
+		}
+	}
+	//appends the geometry of a glyph at the specified pen position
+	void PlaceGlyph(const FText3DGlyphMesh& glyphMesh, FVector2D offsetXY)
+	{
+		const FVector vOffset = FVector(offsetXY, 0);
+		mTextBound += glyphMesh.mBound.ShiftBy(vOffset);
+
+		//p2t triangles are counter clockwise, so the front face looks down -Z and the back face reverses them
+		const bool bGenerate[2] = { mGenerateFontFace, mGenerateBackFace };
+		for (int iFace = 0; iFace < 2; iFace++)
+		{
+			if (!bGenerate[iFace])
+				continue;
+
+			FResultMeshData& face = mMeshes[iFace];
+			const int32 baseVertex = face.vertices.Num();
+			const float z = iFace == 0 ? 0.0f : mExtrude;
+			const FVector normal(0, 0, iFace == 0 ? -1.0f : 1.0f);
+
+			face.vertices.Reserve(baseVertex + glyphMesh.mFaceVertices.Num());
+			for (const FVector2D& vertex : glyphMesh.mFaceVertices)
+			{
+				FTextMeshVertex& placed = face.vertices[face.vertices.AddUninitialized()];
+				placed.Position = FVector(vertex + offsetXY, z);
+				placed.Normal = normal;
+			}
+
+			face.indices.Reserve(face.indices.Num() + glyphMesh.mFaceIndices.Num());
+			for (int32 iIndex = 0; iIndex < glyphMesh.mFaceIndices.Num(); iIndex += 3)
+			{
+				const int32* tri = &glyphMesh.mFaceIndices[iIndex];
+				if (iFace == 0)
+				{
+					face.indices.Add(baseVertex + tri[0]);
+					face.indices.Add(baseVertex + tri[1]);
+					face.indices.Add(baseVertex + tri[2]);
+				}
+				else
+				{
+					face.indices.Add(baseVertex + tri[2]);
+					face.indices.Add(baseVertex + tri[1]);
+					face.indices.Add(baseVertex + tri[0]);
+				}
+			}
+		}
+
+		if (mGenerateSide)
+		{
+			FResultMeshData& side = mMeshes[2];
+			const int32 baseVertex = side.vertices.Num();
+			side.vertices.Append(glyphMesh.mSideVertices);
+			for (int32 iVertex = baseVertex; iVertex < side.vertices.Num(); iVertex++)
+				side.vertices[iVertex].Position += vOffset;
+
+			side.indices.Reserve(side.indices.Num() + glyphMesh.mSideIndices.Num());
+			for (int32 index : glyphMesh.mSideIndices)
+				side.indices.Add(baseVertex + index);
+		}
+	}
+	void Shape(FVector2D start = FVector2D(0,0))
+	{
+		hb_buffer_t* hbBuffer = hb_buffer_create();
+		if (hbBuffer == nullptr) return;
+
+		Shape(hbBuffer, start);
+		hb_buffer_destroy(hbBuffer);
+	}
+	//shapes the text with a buffer that can be shared by the shapers of one thread
+	void Shape(hb_buffer_t* hbBuffer, FVector2D start)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Shaping);
+
+		FVector2D offset = start;
+		if (mLineCache.IsValid())
+			mLineCache->BeginBuild(MakeLineSettings());
+		
+		hb_font_t* hbFont = mFace->mHBFont;
+
+
+		hb_script_t hbScript = hb_script_from_string(mScript, -1);
+
+		TArray<FString> linesText;
+		mText.ParseIntoArrayLines(linesText, false);
+
+		for (int iLine = 0; iLine < linesText.Num(); iLine++) //for each line
+		{
+			
+
+			FString& lineText = linesText[iLine];
+
+			//a cached line only needs its placements moved to the pen position
+			FShapedLine& shapedLine = mLines[mLines.AddDefaulted()];
+			shapedLine.mText = lineText;
+			shapedLine.mOrigin = offset;
+			shapedLine.mFirstPlacement = mPlacements.Num();
+			shapedLine.mLine = mLineCache.IsValid() ? mLineCache->Find(lineText) : nullptr;
+			shapedLine.mReused = shapedLine.mLine.IsValid();
+			if (shapedLine.mReused)
+			{
+				for (const FGlyphPlacement& placement : shapedLine.mLine->mPlacements)
+					mPlacements.Add(FGlyphPlacement{ placement.mGlyphIndex, offset + placement.mOffset });
+			}
+
+			TArray<TextBiDi::FTextDirectionInfo> directionsInfo;
+			if (!shapedLine.mReused)
+				TextBiDi::ComputeTextDirection(lineText, TextBiDi::ComputeBaseDirection(lineText), directionsInfo);
+
+			for (TextBiDi::FTextDirectionInfo dirInfo : directionsInfo) //for each section
+			{
+				hb_direction_t curDir = dirInfo.TextDirection == TextBiDi::ETextDirection::LeftToRight ? HB_DIRECTION_LTR : HB_DIRECTION_RTL;
+
+				hb_buffer_reset(hbBuffer);
+
+				hb_buffer_set_direction(hbBuffer, curDir);
+				hb_buffer_set_script(hbBuffer, hbScript);
+				hb_buffer_set_language(hbBuffer, mTextLanguage);
+
+				size_t length = dirInfo.Length;
+				
+				const uint16_t* sectionText = ((const uint16_t*)(*lineText)) + dirInfo.StartIndex;
+				hb_buffer_add_utf16(hbBuffer, sectionText, length, 0, length);
+				//hb_buffer_guess_segment_properties(hbBuffer);
+				{
+					FScopeLock faceLock(&mFace->mLock);
+					hb_shape(hbFont, hbBuffer, nullptr, 0);
+				}
+
+				unsigned int glyphCount;
+				hb_glyph_info_t *glyphInfo = hb_buffer_get_glyph_infos(hbBuffer, &glyphCount);
+				hb_glyph_position_t *glyphPos = hb_buffer_get_glyph_positions(hbBuffer, &glyphCount);
+
+				if (glyphInfo == nullptr || glyphPos == nullptr)
+				{
+					shapedLine.mNumPlacements = mPlacements.Num() - shapedLine.mFirstPlacement;
+					return;
+				}
+
+				
+
+				for (unsigned iGlyph = 0; iGlyph < glyphCount; iGlyph++) //for each glyph
+				{
+					if (IsCancelled())
+					{
+						shapedLine.mNumPlacements = mPlacements.Num() - shapedLine.mFirstPlacement;
+						return;
+					}
+
+					//index in glyph map
+					auto codePoint = glyphInfo[iGlyph].codepoint;
+					//utf16 code
+					auto characterCode = sectionText[glyphInfo[iGlyph].cluster];
+
+					FVector2D glyphAdvace = FVector2D((float)glyphPos[iGlyph].x_advance / 64, (float)glyphPos[iGlyph].y_advance / 64);
+					FVector2D glyphOffset = FVector2D((float)glyphPos[iGlyph].x_offset / 64, (float)glyphPos[iGlyph].y_offset / 64);
+
+					//float xa = (float)glyphPos[iGlyph].x_advance / 64;
+					//float ya = (float)glyphPos[iGlyph].y_advance / 64;
+					//float xo = (float)glyphPos[iGlyph].x_offset / 64;
+					//float yo = (float)glyphPos[iGlyph].y_offset / 64;
+
+
+					if (characterCode == '\t')
+					{
+						glyphAdvace *= 3; //how many space is a tab?
+					}
+					else if (characterCode == ' ')
+					{
+
+					}
+					else
+					{
+						mPlacements.Add(FGlyphPlacement{ codePoint, offset + glyphOffset });
+					}
+
+					//x += xa;
+					//y += ya;
+
+					offset += glyphAdvace;
+
+
+				}
+
+				
+			}
+
+			
+			shapedLine.mNumPlacements = mPlacements.Num() - shapedLine.mFirstPlacement;
+			if (mLineCache.IsValid() && !shapedLine.mReused)
+			{
+				//the geometry is added by PlaceGlyphs, the line is cached once it's complete
+				shapedLine.mLine = MakeShareable(new FText3DLine);
+				for (int32 iPlacement = shapedLine.mFirstPlacement; iPlacement < mPlacements.Num(); iPlacement++)
+					shapedLine.mLine->mPlacements.Add(FGlyphPlacement{ mPlacements[iPlacement].mGlyphIndex, mPlacements[iPlacement].mOffset - shapedLine.mOrigin });
+			}
+
+			offset.X = start.X;
+			offset.Y -= (mLineSpace);
+		}
+	}
+	//offset that aligns mTextBound as requested
+	FVector CalcAlignment() const
+	{
+		FVector v(0, 0, 0);
+		if (!mTextBound.IsValid)
+			return v;
+
+		if (mHTA == EText3DHAlign::LEFT)
+			v.X = -mTextBound.Min.X;
+		else if (mHTA == EText3DHAlign::RIGHT)
+			v.X = -mTextBound.Max.X;
+		else
+			v.X = -mTextBound.GetCenter().X;
+
+		if (mVTA == EText3DVAlign::BOTTOM)
+			v.Y = -mTextBound.Min.Y;
+		else if (mVTA == EText3DVAlign::TOP)
+			v.Y = -mTextBound.Max.Y;
+		else
+			v.Y = -mTextBound.GetCenter().Y;
+
+		return v;
+	}
+	FMeshResultFinal* GetMesh()
+	{
+		FMeshResultFinal* result = IndexMesh();
+		TransformMesh(*result);
+		BuildLODs(*result);
+
+		if (mLineCache.IsValid() && !IsCancelled())
+			mLineCache->EndBuild();
+		return result;
+	}
+	//hands the indexed meshes over to a result, still in text space
+	FMeshResultFinal* IndexMesh()
+	{
+		FMeshResultFinal* result = new FMeshResultFinal;
+		TakeMeshes(result->mMeshes);
+		return result;
+	}
+	void TakeMeshes(FResultMeshData outMeshes[3])
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Indexing);
+
+		for (int iMesh = 0; iMesh < 3; iMesh++)
+		{
+			outMeshes[iMesh] = MoveTemp(mMeshes[iMesh]);
+			INC_DWORD_STAT_BY(STAT_Text3D_Triangles, outMeshes[iMesh].indices.Num() / 3);
+			INC_DWORD_STAT_BY(STAT_Text3D_Vertices, outMeshes[iMesh].vertices.Num());
+		}
+	}
+	//aligns and transforms the welded vertices in a single pass and converts them to the vertex format of the component.
+	//the bounds come from the glyph bounds instead of the vertices
+	void TransformMesh(FMeshResultFinal& mesh)
+	{
+		mPositionMatrix = FTranslationMatrix(CalcAlignment()) * mTransform.ToMatrixWithScale();
+		//the normal of a transformed triangle, a mirroring transform flips the winding and so the normal
+		mNormalMatrix = mPositionMatrix.Inverse().GetTransposed() * (mPositionMatrix.Determinant() < 0 ? -1.0f : 1.0f);
+
+		mesh.mBound = mTextBound.IsValid ? mTextBound.TransformBy(mPositionMatrix) : FBox(ForceInit);
+		TransformMeshes(mesh.mMeshes);
+
+		//instanced glyphs stay at the origin, the translation goes to their offsets
+		if (mGlyphs.Num())
+		{
+			for (FMeshResultGlyph& glyph : mGlyphs)
+			{
+				for (FVector& offset : glyph.mOffsets)
+					offset = mPositionMatrix.TransformPosition(offset);
+			}
+			mPositionMatrix.SetOrigin(FVector::ZeroVector);
+			for (FMeshResultGlyph& glyph : mGlyphs)
+				TransformMeshes(glyph.mMeshes);
+			mesh.mGlyphs = MoveTemp(mGlyphs);
+		}
+	}
+	//applies the matrices of TransformMesh
+	void TransformMeshes(FResultMeshData meshes[3])
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Text3D_Transform);
+
+		for (int iMesh = 0; iMesh < 3; iMesh++)
+		{
+			for (FTextMeshVertex& vertex : meshes[iMesh].vertices)
+			{
+				vertex.Position = mPositionMatrix.TransformPosition(vertex.Position);
+				vertex.Normal = mNormalMatrix.TransformVector(vertex.Normal).GetSafeNormal();
+			}
+			meshes[iMesh].Compact(mVertexFormat);
+		}
+	}
+	//curve settings of LOD 0 and of every coarser level, returns the number of levels worth building.
+	//each level halves the most segments a curve can get and quadruples the tolerance, which roughly halves the segments it gives.
+	//text without a tolerance gets one from the em size. the levels stop as soon as one gives the same segments as the previous one
+	int32 CalcLODCurves(FText3DLODCurves outCurves[FMeshResultFinal::MaxLODs]) const
+	{
+		const float emSize = (mFace.IsValid() && mFace->mFace->size) ? (float)mFace->mFace->size->metrics.y_ppem : 64.0f;
+		const float maxTolerance = emSize * GText3DMaxLODTolerance;
+
+		outCurves[0] = FText3DLODCurves{ mBezierSteps, mBezierTolerance, mMaxCurveSteps };
+		float tolerance = mBezierTolerance > 0 ? mBezierTolerance : emSize * GText3DFirstLODTolerance / 4;
+		int maxSteps = mBezierTolerance > 0 ? mMaxCurveSteps : mBezierSteps;
+
+		int32 numLODs = 1;
+		for (; numLODs < mNumLODs; numLODs++)
+		{
+			tolerance = FMath::Min(tolerance * 4, maxTolerance);
+			maxSteps = FMath::Max(maxSteps / 2, 1);
+
+			//a single segment per curve doesn't need a tolerance
+			FText3DLODCurves& curves = outCurves[numLODs];
+			curves = maxSteps == 1 ? FText3DLODCurves{ 1, 0, 1 } : FText3DLODCurves{ maxSteps, tolerance, maxSteps };
+			if (curves == outCurves[numLODs - 1])
+				break;
+		}
+		return numLODs;
+	}
+	//places the glyphs again for every coarser level of detail, with the alignment of LOD 0.
+	//see CalcLODCurves, the last level drops the side walls
+	void BuildLODs(FMeshResultFinal& mesh)
+	{
+		const int baseSteps = mBezierSteps;
+		const float baseTolerance = mBezierTolerance;
+		const int baseMaxCurveSteps = mMaxCurveSteps;
+		const bool baseGenerateSide = mGenerateSide;
+		const TMap<uint32, FText3DGlyphMeshPtr>* baseResolvedGlyphs = mResolvedGlyphs;
+
+		FText3DLODCurves lodCurves[FMeshResultFinal::MaxLODs];
+		const int32 numLODs = CalcLODCurves(lodCurves);
+
+		mReuseLines = false;
+		mResolvedGlyphs = nullptr;
+
+		for (int32 iLOD = 1; iLOD < numLODs && !IsCancelled(); iLOD++)
+		{
+			mBezierSteps = lodCurves[iLOD].mSteps;
+			mBezierTolerance = lodCurves[iLOD].mTolerance;
+			mMaxCurveSteps = lodCurves[iLOD].mMaxSteps;
+			mGenerateSide = baseGenerateSide && iLOD < numLODs - 1;
+
+			PlaceGlyphs();
+			FMeshResultLOD& lod = mesh.mLODs[mesh.mLODs.AddDefaulted()];
+			TakeMeshes(lod.mMeshes);
+			TransformMeshes(lod.mMeshes);
+		}
+
+		mBezierSteps = baseSteps;
+		mBezierTolerance = baseTolerance;
+		mMaxCurveSteps = baseMaxCurveSteps;
+		mGenerateSide = baseGenerateSide;
+		mResolvedGlyphs = baseResolvedGlyphs;
+		mReuseLines = true;
+	}
+	//builds the side wall of a contour as an indexed quad strip. the normals of neighbouring segments are averaged
+	//if they meet at less than mSmoothingAngle, harder corners get a vertex for each segment
+	void GenSideWall(const Contour& contour, FText3DGlyphMesh& outMesh)
+	{
+		const int32 numPoints = (int32)contour.PointCount();
+		if (numPoints < 2)
+			return;
+
+		auto LPoint = [&contour](int32 index)
+		{
+			const Point& point = contour.GetPoint(index);
+			return FVector2D(point.X(), point.Y()) / 64.0f;
+		};
+
+		//normal of the segment from point i to point i + 1, facing out of the glyph
+		TArray<FVector, TInlineAllocator<128>> segmentNormals;
+		segmentNormals.SetNumUninitialized(numPoints);
+		for (int32 iPoint = 0; iPoint < numPoints; iPoint++)
+		{
+			const FVector2D dir = LPoint((iPoint + 1) % numPoints) - LPoint(iPoint);
+			segmentNormals[iPoint] = FVector(-dir.Y, dir.X, 0).GetSafeNormal();
+		}
+
+		//first vertex of the pair at the end of the previous segment and at the start of the next one, a pair is the bottom and top vertex
+		TArray<int32, TInlineAllocator<128>> endPairs, startPairs;
+		endPairs.SetNumUninitialized(numPoints);
+		startPairs.SetNumUninitialized(numPoints);
+
+		const float smoothingCos = FMath::Cos(FMath::DegreesToRadians(mSmoothingAngle));
+		auto LAddPair = [&](const FVector2D& position, const FVector& normal)
+		{
+			const int32 index = outMesh.mSideVertices.AddUninitialized(2);
+			outMesh.mSideVertices[index].Position = FVector(position, 0);
+			outMesh.mSideVertices[index].Normal = normal;
+			outMesh.mSideVertices[index + 1].Position = FVector(position, mExtrude);
+			outMesh.mSideVertices[index + 1].Normal = normal;
+			return index;
+		};
+
+		for (int32 iPoint = 0; iPoint < numPoints; iPoint++)
+		{
+			const FVector& prevNormal = segmentNormals[(iPoint + numPoints - 1) % numPoints];
+			const FVector& nextNormal = segmentNormals[iPoint];
+			const FVector2D position = LPoint(iPoint);
+
+			if (mSmoothingAngle > 0 && FVector::DotProduct(prevNormal, nextNormal) >= smoothingCos)
+			{
+				endPairs[iPoint] = startPairs[iPoint] = LAddPair(position, (prevNormal + nextNormal).GetSafeNormal());
+			}
+			else
+			{
+				endPairs[iPoint] = LAddPair(position, prevNormal);
+				startPairs[iPoint] = LAddPair(position, nextNormal);
+			}
+		}
+
+		outMesh.mSideIndices.Reserve(outMesh.mSideIndices.Num() + numPoints * 6);
+		for (int32 iPoint = 0; iPoint < numPoints; iPoint++)
+		{
+			const int32 p0 = startPairs[iPoint];
+			const int32 p1 = endPairs[(iPoint + 1) % numPoints];
+
+			outMesh.mSideIndices.Add(p0);
+			outMesh.mSideIndices.Add(p1);
+			outMesh.mSideIndices.Add(p0 + 1);
+
+			outMesh.mSideIndices.Add(p1 + 1);
+			outMesh.mSideIndices.Add(p0 + 1);
+			outMesh.mSideIndices.Add(p1);
+		}
+	}
+};
+
+#endif
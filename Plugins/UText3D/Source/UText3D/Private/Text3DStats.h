@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Text3D"), STATGROUP_Text3D, STATCAT_Advanced);
+
+//pipeline stages
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build"), STAT_Text3D_Build, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Face Creation"), STAT_Text3D_FaceCreation, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Shaping"), STAT_Text3D_Shaping, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Vectorise"), STAT_Text3D_Vectorise, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Triangulate"), STAT_Text3D_Triangulate, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Place Glyphs"), STAT_Text3D_PlaceGlyphs, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Alignment And Transform"), STAT_Text3D_Transform, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Indexing"), STAT_Text3D_Indexing, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Mesh"), STAT_Text3D_ApplyMesh, STATGROUP_Text3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RHI Upload"), STAT_Text3D_Upload, STATGROUP_Text3D, );
+
+//per frame counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Glyphs Processed"), STAT_Text3D_Glyphs, STATGROUP_Text3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Triangles Emitted"), STAT_Text3D_Triangles, STATGROUP_Text3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Vertices After Welding"), STAT_Text3D_Vertices, STATGROUP_Text3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Glyph Cache Hits"), STAT_Text3D_GlyphCacheHits, STATGROUP_Text3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Glyph Cache Misses"), STAT_Text3D_GlyphCacheMisses, STATGROUP_Text3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Lines Reused"), STAT_Text3D_ReusedLines, STATGROUP_Text3D, );
+
+//running totals
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Builds In Flight"), STAT_Text3D_BuildsInFlight, STATGROUP_Text3D, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queued Builds"), STAT_Text3D_QueuedBuilds, STATGROUP_Text3D, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cached Glyphs"), STAT_Text3D_CachedGlyphs, STATGROUP_Text3D, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cached Faces"), STAT_Text3D_CachedFaces, STATGROUP_Text3D, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Glyph Cache Memory"), STAT_Text3D_GlyphCacheMemory, STATGROUP_Text3D, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Render Buffer Memory"), STAT_Text3D_RenderBufferMemory, STATGROUP_Text3D, );
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PackedNormal.h"
+
+//vertex of EText3DVertexFormat::PACKED_NORMAL
+struct FText3DPackedVertex
+{
+	FVector Position;
+	FPackedNormal Normal;
+};
+
+
+//per instance data of instanced glyphs, in the stream layout of FInstancedStaticMeshVertexFactory
+struct FText3DInstanceVertex
+{
+	FVector4 Origin;	//glyph offset in component space, w is the per instance random value
+	FVector4 Transform[3];	//rows of the instance rotation and scale, w holds the hit proxy and selection
+	int16 LightmapAndShadowMapUVBias[4];
+};
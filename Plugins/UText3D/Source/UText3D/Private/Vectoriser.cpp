@@ -27,7 +27,69 @@
 
 #include "Vectoriser.h"
 
-Vectoriser::Vectoriser(const FT_GlyphSlot glyph, unsigned short bezierSteps)
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    /**
+     * Leftmost point and bounding box of a contour
+     */
+    struct ContourBounds
+    {
+        Point leftmost;
+        double minX, minY, maxX, maxY;
+
+        double Area() const { return (maxX - minX) * (maxY - minY); }
+    };
+
+    /**
+     * Count the edges of a contour crossed by a ray going to the left of
+     * the specified point.
+     */
+    int CountCrossings(const Contour* contour, const Point& leftmost)
+    {
+        int crossings = 0;
+
+        for(size_t n = 0; n < contour->PointCount(); n++)
+        {
+            const Point& p1 = contour->GetPoint(n);
+            const Point& p2 = contour->GetPoint((n + 1) % contour->PointCount());
+
+            /* FIXME: combinations of >= > <= and < do not seem stable */
+            if((p1.Y() < leftmost.Y() && p2.Y() < leftmost.Y())
+                || (p1.Y() >= leftmost.Y() && p2.Y() >= leftmost.Y())
+                || (p1.X() > leftmost.X() && p2.X() > leftmost.X()))
+            {
+                continue;
+            }
+            else if(p1.X() < leftmost.X() && p2.X() < leftmost.X())
+            {
+                crossings++;
+            }
+            else
+            {
+                // Test the edge from its lower end, otherwise the side of
+                // the crossing depends on the direction of the contour,
+                // which SetParity may already have reversed.
+                Point a = p1 - leftmost;
+                Point b = p2 - leftmost;
+                if(a.Y() >= 0.0)
+                {
+                    std::swap(a, b);
+                }
+                if(b.X() * a.Y() > b.Y() * a.X())
+                {
+                    crossings++;
+                }
+            }
+        }
+
+        return crossings;
+    }
+}
+
+Vectoriser::Vectoriser(const FT_GlyphSlot glyph, unsigned short bezierSteps, double tolerance, unsigned short maxSteps)
 :   contourList(0),
     ftContourCount(0),
     contourFlag(0)
@@ -40,7 +102,7 @@ Vectoriser::Vectoriser(const FT_GlyphSlot glyph, unsigned short bezierSteps)
         contourList = 0;
         contourFlag = outline.flags;
 
-        ProcessContours(bezierSteps);
+        ProcessContours(bezierSteps, tolerance, maxSteps);
     }
 }
 
@@ -56,13 +118,14 @@ Vectoriser::~Vectoriser()
 }
 
 
-void Vectoriser::ProcessContours(unsigned short bezierSteps)
+void Vectoriser::ProcessContours(unsigned short bezierSteps, double tolerance, unsigned short maxSteps)
 {
     short contourLength = 0;
     short startIndex = 0;
     short endIndex = 0;
 
     contourList = new Contour*[ftContourCount];
+    contourParents.assign(ftContourCount, -1);
 
     for(int i = 0; i < ftContourCount; ++i)
     {
@@ -72,74 +135,116 @@ void Vectoriser::ProcessContours(unsigned short bezierSteps)
         endIndex = outline.contours[i];
         contourLength =  (endIndex - startIndex) + 1;
 
-        Contour* contour = new Contour(pointList, tagList, contourLength, bezierSteps);
+        Contour* contour = new Contour(pointList, tagList, contourLength, bezierSteps, tolerance, maxSteps);
 
         contourList[i] = contour;
 
         startIndex = endIndex + 1;
     }
 
-    // Compute each contour's parity. FIXME: see if FT_Outline_Get_Orientation
-    // can do it for us.
+    // Compute each contour's parity: count how many edges of the other
+    // contours a ray going left from its leftmost point crosses. Only the
+    // contours whose bounding box straddles the ray can be crossed, so the
+    // rays are swept from bottom to top while a list of the contours whose
+    // y range is open at the current ray is kept. This gives the same
+    // parity as testing every contour against every other one, but only
+    // walks the edges of contours that can actually be hit.
+    //
+    // A contour crossed an odd number of times contains the ray origin,
+    // and so the whole contour since outlines don't intersect. The
+    // smallest of those is the parent of the contour.
+    std::vector<ContourBounds> bounds(ftContourCount);
+    std::vector<int> rays(ftContourCount);
+    std::vector<int> byMinY(ftContourCount);
+
     for(int i = 0; i < ftContourCount; i++)
     {
-        Contour *c1 = contourList[i];
+        const Contour *c = contourList[i];
+        ContourBounds& b = bounds[i];
 
-        // 1. Find the leftmost point.
-        Point leftmost(65536.0, 0.0);
+        // 1. Find the leftmost point and the bounding box.
+        b.leftmost = Point(65536.0, 0.0);
+        b.minX = b.minY = std::numeric_limits<double>::max();
+        b.maxX = b.maxY = -std::numeric_limits<double>::max();
 
-        for(size_t n = 0; n < c1->PointCount(); n++)
+        for(size_t n = 0; n < c->PointCount(); n++)
         {
-            Point p = c1->GetPoint(n);
-            if(p.X() < leftmost.X())
+            const Point& p = c->GetPoint(n);
+            if(p.X() < b.leftmost.X())
             {
-                leftmost = p;
+                b.leftmost = p;
             }
+            b.minX = std::min(b.minX, p.X());
+            b.minY = std::min(b.minY, p.Y());
+            b.maxX = std::max(b.maxX, p.X());
+            b.maxY = std::max(b.maxY, p.Y());
+        }
+
+        rays[i] = i;
+        byMinY[i] = i;
+    }
+
+    std::sort(rays.begin(), rays.end(), [&bounds](int a, int b)
+    {
+        return bounds[a].leftmost.Y() < bounds[b].leftmost.Y();
+    });
+    std::sort(byMinY.begin(), byMinY.end(), [&bounds](int a, int b)
+    {
+        return bounds[a].minY < bounds[b].minY;
+    });
+
+    std::vector<int> active;
+    size_t nextContour = 0;
+
+    for(size_t r = 0; r < rays.size(); r++)
+    {
+        const int i = rays[r];
+        const Point& leftmost = bounds[i].leftmost;
+
+        // 2. Open the contours that have a point below the ray and close
+        // the ones that are entirely below it. An edge is only crossed if
+        // one end is below the ray and the other one is not.
+        while(nextContour < byMinY.size()
+              && bounds[byMinY[nextContour]].minY < leftmost.Y())
+        {
+            active.push_back(byMinY[nextContour++]);
         }
 
-        // 2. Count how many other contours we cross when going further to
-        // the left.
         int parity = 0;
+        int parent = -1;
 
-        for(int j = 0; j < ftContourCount; j++)
+        for(size_t a = 0; a < active.size();)
         {
-            if(j == i)
+            const int j = active[a];
+            if(bounds[j].maxY < leftmost.Y())
             {
+                active[a] = active.back();
+                active.pop_back();
                 continue;
             }
+            a++;
 
-            Contour *c2 = contourList[j];
-
-            for(size_t n = 0; n < c2->PointCount(); n++)
+            if(j == i || bounds[j].minX > leftmost.X())
             {
-                Point p1 = c2->GetPoint(n);
-                Point p2 = c2->GetPoint((n + 1) % c2->PointCount());
+                continue;
+            }
 
-                /* FIXME: combinations of >= > <= and < do not seem stable */
-                if((p1.Y() < leftmost.Y() && p2.Y() < leftmost.Y())
-                    || (p1.Y() >= leftmost.Y() && p2.Y() >= leftmost.Y())
-                    || (p1.X() > leftmost.X() && p2.X() > leftmost.X()))
-                {
-                    continue;
-                }
-                else if(p1.X() < leftmost.X() && p2.X() < leftmost.X())
-                {
-                    parity++;
-                }
-                else
-                {
-                    Point a = p1 - leftmost;
-                    Point b = p2 - leftmost;
-                    if(b.X() * a.Y() > b.Y() * a.X())
-                    {
-                        parity++;
-                    }
-                }
+            // 3. Count how many edges of this contour we cross when going
+            // further to the left, and find the innermost one around us.
+            const int crossings = CountCrossings(contourList[j], leftmost);
+            parity += crossings;
+
+            if((crossings & 1)
+               && (parent < 0 || bounds[j].Area() < bounds[parent].Area()))
+            {
+                parent = j;
             }
         }
 
-        // 3. Make sure the glyph has the proper parity.
-        c1->SetParity(parity);
+        contourParents[i] = parent;
+
+        // 4. Make sure the glyph has the proper parity.
+        contourList[i]->SetParity(parity);
     }
 }
 
@@ -162,3 +267,9 @@ const Contour* const Vectoriser::GetContour(size_t index) const
 }
 
 
+int Vectoriser::GetParent(size_t index) const
+{
+    return (index < ContourCount()) ? contourParents[index] : -1;
+}
+
+
@@ -53,8 +53,12 @@ class Vectoriser {
          * Constructor
          *
          * @param glyph The freetype glyph to be processed
+         * @param bezierSteps Number of segments per curve
+         * @param tolerance Maximum curve to segment distance in 26.6 units,
+         *                  replaces bezierSteps if greater than zero
+         * @param maxSteps Most segments per curve with a tolerance
          */
-        Vectoriser(const FT_GlyphSlot glyph, unsigned short bezierSteps);
+        Vectoriser(const FT_GlyphSlot glyph, unsigned short bezierSteps, double tolerance = 0.0, unsigned short maxSteps = 64);
 
         /**
          *  Destructor
@@ -82,6 +86,15 @@ class Vectoriser {
          */
         const Contour* const GetContour(size_t index) const;
 
+        /**
+         * Return the innermost contour that contains the contour at index.
+         * A hole has exactly one parent, the outline it is cut from.
+         *
+         * @return the index of the parent or -1 if the contour isn't
+         *         inside any other contour
+         */
+        int GetParent(size_t index) const;
+
         /**
          * Get the number of points in a specific contour in this outline
          *
@@ -104,13 +117,18 @@ class Vectoriser {
          * @param front front outset distance
          * @param back back outset distance
          */
-        void ProcessContours(unsigned short bezierSteps);
+        void ProcessContours(unsigned short bezierSteps, double tolerance, unsigned short maxSteps);
 
         /**
          * The list of contours in the glyph
          */
         Contour** contourList;
 
+        /**
+         * The index of the innermost contour around each contour
+         */
+        std::vector<int> contourParents;
+
         /**
          * The number of contours reported by Freetype
          */
@@ -101,8 +101,4 @@ Node* AdvancingFront::LocatePoint(const Point* point)
   return node;
 }
 
-AdvancingFront::~AdvancingFront()
-{
-}
-
 }
\ No newline at end of file
@@ -63,8 +63,6 @@ class AdvancingFront {
 public:
 
 AdvancingFront(Node& head, Node& tail);
-// Destructor
-~AdvancingFront();
 
 Node* head();
 void set_head(Node* node);
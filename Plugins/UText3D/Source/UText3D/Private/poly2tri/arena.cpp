@@ -0,0 +1,106 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2010, Poly2Tri Contributors
+ * http://code.google.com/p/poly2tri/
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arena.h"
+#include <cstdlib>
+
+namespace p2t {
+
+Arena::Arena() : block_(0), offset_(0)
+{
+}
+
+Arena::~Arena()
+{
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    std::free(blocks_[i].data);
+  }
+}
+
+Arena& Arena::Get()
+{
+  static thread_local Arena arena;
+  return arena;
+}
+
+void* Arena::Allocate(size_t size, size_t align)
+{
+  for (;;) {
+    if (block_ < blocks_.size()) {
+      Block& block = blocks_[block_];
+      size_t start = (offset_ + align - 1) & ~(align - 1);
+      if (start + size <= block.size) {
+        offset_ = start + size;
+        return block.data + start;
+      }
+      // Doesn't fit, continue in the next block
+      block_++;
+      offset_ = 0;
+    } else {
+      Block block;
+      block.size = size + align > kBlockSize ? size + align : kBlockSize;
+      block.data = static_cast<char*>(std::malloc(block.size));
+      if (block.data == NULL) {
+        return NULL;
+      }
+      blocks_.push_back(block);
+    }
+  }
+}
+
+bool Arena::Reserve(size_t size)
+{
+  if (block_ < blocks_.size() && offset_ + size <= blocks_[block_].size) {
+    return true;
+  }
+
+  // Continue in the next block if it's large enough, otherwise a large enough block goes right after the current one.
+  // Markers only refer to the current block and the ones before it, so they stay valid
+  size_t next = block_ < blocks_.size() ? block_ + 1 : block_;
+  if (next < blocks_.size() && blocks_[next].size >= size) {
+    block_ = next;
+    offset_ = 0;
+    return true;
+  }
+
+  Block block;
+  block.size = size > kBlockSize ? size : kBlockSize;
+  block.data = static_cast<char*>(std::malloc(block.size));
+  if (block.data == NULL) {
+    return false;
+  }
+  blocks_.insert(blocks_.begin() + next, block);
+  block_ = next;
+  offset_ = 0;
+  return true;
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2010, Poly2Tri Contributors
+ * http://code.google.com/p/poly2tri/
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace p2t {
+
+/// Bump allocator backing the Points, Triangles, Nodes and Edges of a triangulation.
+/// Objects allocated here are never destructed, they must be trivially destructible.
+class Arena {
+public:
+
+struct Marker {
+  size_t block;
+  size_t offset;
+};
+
+Arena();
+~Arena();
+
+/// Arena of the calling thread
+static Arena& Get();
+
+/// Returns NULL if the memory can't be allocated
+void* Allocate(size_t size, size_t align);
+
+/// Returns NULL if the memory can't be allocated
+template <class T, class... Args>
+T* New(Args&&... args)
+{
+  void* memory = Allocate(sizeof(T), alignof(T));
+  return memory ? new (memory) T(std::forward<Args>(args)...) : NULL;
+}
+
+/// Makes sure the next allocations of up to size bytes in total don't need more memory, returns false if it can't be allocated.
+/// Callers that can't handle a NULL allocation reserve first
+bool Reserve(size_t size);
+
+Marker GetMarker() const;
+
+/// Releases everything allocated after the marker in O(1), the memory blocks are kept for reuse
+void Rewind(const Marker& marker);
+
+private:
+
+struct Block {
+  char* data;
+  size_t size;
+};
+
+static const size_t kBlockSize = 64 * 1024;
+
+std::vector<Block> blocks_;
+size_t block_;
+size_t offset_;
+
+};
+
+/// Rewinds the arena of the calling thread when it goes out of scope
+class ArenaScope {
+public:
+
+ArenaScope() : arena_(Arena::Get()), marker_(arena_.GetMarker())
+{
+}
+
+~ArenaScope()
+{
+  arena_.Rewind(marker_);
+}
+
+private:
+
+Arena& arena_;
+Arena::Marker marker_;
+
+};
+
+inline Arena::Marker Arena::GetMarker() const
+{
+  Marker marker;
+  marker.block = block_;
+  marker.offset = offset_;
+  return marker;
+}
+
+inline void Arena::Rewind(const Marker& marker)
+{
+  block_ = marker.block;
+  offset_ = marker.offset;
+}
+
+}
+
+#endif
@@ -47,9 +47,26 @@ void CDT::AddPoint(Point* point) {
   sweep_context_->AddPoint(point);
 }
 
-void CDT::Triangulate()
+bool CDT::Triangulate()
 {
+  if (!sweep_context_->valid()) {
+    return false;
+  }
   sweep_->Triangulate(*sweep_context_);
+  return true;
+}
+
+size_t CDT::ArenaSize(size_t num_points)
+{
+  // Every object may need padding up to its alignment. The head and tail points are added to the sweep,
+  // every point event creates a triangle and a node, the fills add at most one triangle per final triangle
+  const size_t pad = alignof(std::max_align_t);
+  const size_t n = num_points + 2;
+  return n * (sizeof(Point) + pad)
+    + num_points * (sizeof(Edge) + pad)
+    + (2 * n + 1) * (sizeof(Triangle) + pad)
+    + (n + 3) * (sizeof(Node) + pad)
+    + sizeof(AdvancingFront) + pad;
 }
 
 std::vector<p2t::Triangle*> CDT::GetTriangles()
@@ -57,7 +74,7 @@ std::vector<p2t::Triangle*> CDT::GetTriangles()
   return sweep_context_->GetTriangles();
 }
 
-std::list<p2t::Triangle*> CDT::GetMap()
+std::vector<p2t::Triangle*> CDT::GetMap()
 {
   return sweep_context_->GetMap();
 }
@@ -76,8 +76,17 @@ public:
 
   /**
    * Triangulate - do this AFTER you've added the polyline, holes, and Steiner points
+   *
+   * @return false if the polyline or a hole can't be triangulated, there are no triangles then
+   */
+  bool Triangulate();
+
+  /**
+   * Most Arena memory a triangulation allocates, including its points
+   *
+   * @param num_points points of the polyline and the holes
    */
-  void Triangulate();
+  static size_t ArenaSize(size_t num_points);
 
   /**
    * Get CDT triangles
@@ -87,7 +96,7 @@ public:
   /**
    * Get triangle map
    */
-  std::list<Triangle*> GetMap();
+  std::vector<Triangle*> GetMap();
 
   private:
 
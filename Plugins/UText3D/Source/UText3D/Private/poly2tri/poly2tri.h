@@ -33,6 +33,7 @@
 #define POLY2TRI_H
 
 #include "shapes.h"
+#include "arena.h"
 #include "cdt.h"
 
 #endif
\ No newline at end of file
@@ -51,13 +51,17 @@ struct Point {
   {
     x = 0.0;
     y = 0.0;
+    edge_count = 0;
   }
 
-  /// The edges this point constitutes an upper ending point
-  std::vector<Edge*> edge_list;
+  /// The edges this point constitutes an upper ending point. A polyline point
+  /// belongs to two edges, so it is the upper ending point of two at most.
+  /// Kept inline so that points are trivially destructible and can live in the Arena.
+  Edge* edge_list[2];
+  int edge_count;
 
   /// Construct using coordinates.
-  Point(double x, double y) : x(x), y(y) {}
+  Point(double x, double y) : x(x), y(y), edge_count(0) {}
 
   /// Set this point to all zeros.
   void set_zero()
@@ -123,9 +127,11 @@ struct Point {
 struct Edge {
 
   Point* p, *q;
+  /// False for repeat points or if q is already the upper ending point of two edges, the polygon can't be triangulated then
+  bool valid;
 
   /// Constructor
-  Edge(Point& p1, Point& p2) : p(&p1), q(&p2)
+  Edge(Point& p1, Point& p2) : p(&p1), q(&p2), valid(true)
   {
     if (p1.y > p2.y) {
       q = &p1;
@@ -136,11 +142,15 @@ struct Edge {
         p = &p2;
       } else if (p1.x == p2.x) {
         // Repeat points
-        assert(false);
+        valid = false;
       }
     }
 
-    q->edge_list.push_back(this);
+    if (q->edge_count < 2) {
+      q->edge_list[q->edge_count++] = this;
+    } else {
+      valid = false;
+    }
   }
 };
 
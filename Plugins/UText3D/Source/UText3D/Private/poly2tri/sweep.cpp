@@ -33,6 +33,7 @@
 #include "sweep_context.h"
 #include "advancing_front.h"
 #include "utils.h"
+#include "arena.h"
 #include <stdexcept>
 
 namespace p2t {
@@ -53,7 +54,7 @@ void Sweep::SweepPoints(SweepContext& tcx)
   for (size_t i = 1; i < tcx.point_count(); i++) {
     Point& point = *tcx.GetPoint(i);
     Node* node = &PointEvent(tcx, point);
-    for (unsigned int j = 0; j < point.edge_list.size(); j++) {
+    for (int j = 0; j < point.edge_count; j++) {
       EdgeEvent(tcx, point.edge_list[j], node);
     }
   }
@@ -177,13 +178,12 @@ bool Sweep::IsEdgeSideOfTriangle(Triangle& triangle, Point& ep, Point& eq)
 
 Node& Sweep::NewFrontTriangle(SweepContext& tcx, Point& point, Node& node)
 {
-  Triangle* triangle = new Triangle(point, *node.point, *node.next->point);
+  Triangle* triangle = Arena::Get().New<Triangle>(point, *node.point, *node.next->point);
 
   triangle->MarkNeighbor(*node.triangle);
   tcx.AddToMap(triangle);
 
-  Node* new_node = new Node(point);
-  nodes_.push_back(new_node);
+  Node* new_node = Arena::Get().New<Node>(point);
 
   new_node->next = node.next;
   new_node->prev = &node;
@@ -199,7 +199,7 @@ Node& Sweep::NewFrontTriangle(SweepContext& tcx, Point& point, Node& node)
 
 void Sweep::Fill(SweepContext& tcx, Node& node)
 {
-  Triangle* triangle = new Triangle(*node.prev->point, *node.point, *node.next->point);
+  Triangle* triangle = Arena::Get().New<Triangle>(*node.prev->point, *node.point, *node.next->point);
 
   // TODO: should copy the constrained_edge value from neighbor triangles
   //       for now constrained_edge values are copied during the legalize
@@ -784,10 +784,7 @@ void Sweep::FlipScanEdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle&
 
 Sweep::~Sweep() {
 
-    // Clean up memory
-    for(size_t i = 0; i < nodes_.size(); i++) {
-        delete nodes_[i];
-    }
+    // Nodes and triangles live in the Arena
 
 }
 
@@ -31,6 +31,7 @@
 #include "sweep_context.h"
 #include <algorithm>
 #include "advancing_front.h"
+#include "arena.h"
 
 namespace p2t {
 
@@ -40,7 +41,8 @@ SweepContext::SweepContext(const std::vector<Point*>& polyline) : points_(polyli
   tail_(0),
   af_head_(0),
   af_middle_(0),
-  af_tail_(0)
+  af_tail_(0),
+  valid_(true)
 {
   InitEdges(points_);
 }
@@ -62,7 +64,7 @@ std::vector<Triangle*> &SweepContext::GetTriangles()
   return triangles_;
 }
 
-std::list<Triangle*> &SweepContext::GetMap()
+std::vector<Triangle*> &SweepContext::GetMap()
 {
   return map_;
 }
@@ -87,8 +89,8 @@ void SweepContext::InitTriangulation()
 
   double dx = kAlpha * (xmax - xmin);
   double dy = kAlpha * (ymax - ymin);
-  head_ = new Point(xmax + dx, ymin - dy);
-  tail_ = new Point(xmin - dx, ymin - dy);
+  head_ = Arena::Get().New<Point>(xmax + dx, ymin - dy);
+  tail_ = Arena::Get().New<Point>(xmin - dx, ymin - dy);
 
   // Sort points along y-axis
   std::sort(points_.begin(), points_.end(), cmp);
@@ -100,7 +102,13 @@ void SweepContext::InitEdges(const std::vector<Point*>& polyline)
   size_t num_points = polyline.size();
   for (size_t i = 0; i < num_points; i++) {
     size_t j = i < num_points - 1 ? i + 1 : 0;
-    edge_list.push_back(new Edge(*polyline[i], *polyline[j]));
+    Edge* edge = Arena::Get().New<Edge>(*polyline[i], *polyline[j]);
+    if (edge == NULL) {
+      valid_ = false;
+      continue;
+    }
+    valid_ = valid_ && edge->valid;
+    edge_list.push_back(edge);
   }
 }
 
@@ -125,14 +133,15 @@ void SweepContext::CreateAdvancingFront(const std::vector<Node*>& nodes)
 
   (void) nodes;
   // Initial triangle
-  Triangle* triangle = new Triangle(*points_[0], *tail_, *head_);
+  Arena& arena = Arena::Get();
+  Triangle* triangle = arena.New<Triangle>(*points_[0], *tail_, *head_);
 
   map_.push_back(triangle);
 
-  af_head_ = new Node(*triangle->GetPoint(1), *triangle);
-  af_middle_ = new Node(*triangle->GetPoint(0), *triangle);
-  af_tail_ = new Node(*triangle->GetPoint(2));
-  front_ = new AdvancingFront(*af_head_, *af_tail_);
+  af_head_ = arena.New<Node>(*triangle->GetPoint(1), *triangle);
+  af_middle_ = arena.New<Node>(*triangle->GetPoint(0), *triangle);
+  af_tail_ = arena.New<Node>(*triangle->GetPoint(2));
+  front_ = arena.New<AdvancingFront>(*af_head_, *af_tail_);
 
   // TODO: More intuitive if head is middles next and not previous?
   //       so swap head and tail
@@ -144,7 +153,8 @@ void SweepContext::CreateAdvancingFront(const std::vector<Node*>& nodes)
 
 void SweepContext::RemoveNode(Node* node)
 {
-  delete node;
+  // Nodes live in the Arena
+  (void) node;
 }
 
 void SweepContext::MapTriangleToNodes(Triangle& t)
@@ -160,7 +170,7 @@ void SweepContext::MapTriangleToNodes(Triangle& t)
 
 void SweepContext::RemoveFromMap(Triangle* triangle)
 {
-  map_.remove(triangle);
+  map_.erase(std::remove(map_.begin(), map_.end(), triangle), map_.end());
 }
 
 void SweepContext::MeshClean(Triangle& triangle)
@@ -186,25 +196,8 @@ void SweepContext::MeshClean(Triangle& triangle)
 SweepContext::~SweepContext()
 {
 
-    // Clean up memory
-
-    delete head_;
-    delete tail_;
-    delete front_;
-    delete af_head_;
-    delete af_middle_;
-    delete af_tail_;
-
-    typedef std::list<Triangle*> type_list;
-
-    for(type_list::iterator iter = map_.begin(); iter != map_.end(); ++iter) {
-        Triangle* ptr = *iter;
-        delete ptr;
-    }
-
-     for(unsigned int i = 0; i < edge_list.size(); i++) {
-        delete edge_list[i];
-    }
+    // Points, edges, nodes, triangles and the front live in the Arena,
+    // they are released when the arena is rewound
 
 }
 
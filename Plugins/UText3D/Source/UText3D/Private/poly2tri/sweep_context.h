@@ -32,7 +32,6 @@
 #ifndef SWEEP_CONTEXT_H
 #define SWEEP_CONTEXT_H
 
-#include <list>
 #include <vector>
 #include <cstddef>
 
@@ -79,6 +78,9 @@ void AddToMap(Triangle* triangle);
 
 Point* GetPoint(size_t index);
 
+/// False if an edge of the polyline or of a hole is invalid, see Edge::valid
+bool valid() const;
+
 Point* GetPoints();
 
 void RemoveFromMap(Triangle* triangle);
@@ -92,7 +94,7 @@ AdvancingFront* front() const;
 void MeshClean(Triangle& triangle);
 
 std::vector<Triangle*> &GetTriangles();
-std::list<Triangle*> &GetMap();
+std::vector<Triangle*> &GetMap();
 
 std::vector<Edge*> edge_list;
 
@@ -134,7 +136,7 @@ private:
 friend class Sweep;
 
 std::vector<Triangle*> triangles_;
-std::list<Triangle*> map_;
+std::vector<Triangle*> map_;
 std::vector<Point*> points_;
 
 // Advancing front
@@ -146,11 +148,18 @@ Point* tail_;
 
 Node *af_head_, *af_middle_, *af_tail_;
 
+bool valid_;
+
 void InitTriangulation();
 void InitEdges(const std::vector<Point*>& polyline);
 
 };
 
+inline bool SweepContext::valid() const
+{
+  return valid_;
+}
+
 inline AdvancingFront* SweepContext::front() const
 {
   return front_;
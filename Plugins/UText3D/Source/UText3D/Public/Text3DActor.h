@@ -13,4 +13,10 @@ public:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	UText3DComponent* TextComponent;
+
+#if WITH_EDITORONLY_DATA
+	//content folder of the static meshes created by the bake button of the UText3DEditor module
+	UPROPERTY(EditAnywhere, Category = Bake)
+	FString BakePath;
+#endif
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Components/MeshComponent.h"
+#include "HAL/ThreadSafeCounter.h"
 
 #include "Text3DComponent.generated.h"
 
@@ -30,23 +31,76 @@ struct FTextMeshVertex
 	FVector Normal;
 };
 
-struct FResultMeshData
+//layout of the generated vertices on the CPU and GPU
+UENUM()
+enum class EText3DVertexFormat : uint8
+{
+	//float3 position and normal, 24 bytes
+	FLOAT,
+	//float3 position and packed normal, 16 bytes. indices are 16 bit when the section has at most 65536 vertices
+	PACKED_NORMAL,
+	//no longer supported, half float positions are too coarse for long or transformed text. builds as PACKED_NORMAL,
+	//the value is only kept so that saved components still load
+	HALF_POSITION UMETA(Hidden),
+};
+
+struct UTEXT3D_API FResultMeshData
 {
 	TArray<FTextMeshVertex> vertices;
 	TArray<int32> indices;
 
+	//filled by Compact(), vertices and indices are empty then. compactIndices is only used if every vertex fits in 16 bit
+	EText3DVertexFormat format = EText3DVertexFormat::FLOAT;
+	TArray<uint8> compactVertices;
+	TArray<uint16> compactIndices;
+
+	//converts the vertices and indices to the specified format
+	void Compact(EText3DVertexFormat inFormat);
+
+	int32 NumVertices() const;
+	int32 NumIndices() const;
+	//size of a vertex and an index in bytes
+	uint32 GetVertexStride() const;
+	uint32 GetIndexStride() const;
+	const void* GetVertexData() const;
+	const void* GetIndexData() const;
+	FVector GetPosition(int32 vertexIndex) const;
+	FVector GetNormal(int32 vertexIndex) const;
+	int32 GetIndex(int32 index) const;
+
 	FBox CalcBound() const
 	{
 		FBox box(ForceInit);
-		for (const FTextMeshVertex& vertex : vertices)
-			box += vertex.Position;
+		for (int32 iVertex = 0; iVertex < NumVertices(); iVertex++)
+			box += GetPosition(iVertex);
 		return box;
 	}
 };
-struct FMeshResultFinal
+//a coarser level of detail of the generated mesh
+struct FMeshResultLOD
+{
+	FResultMeshData	mMeshes[3];	//front back side
+};
+
+//a distinct glyph of instanced text, built once at the origin and drawn at each of its occurrences
+struct FMeshResultGlyph
 {
 	FResultMeshData	mMeshes[3];	//front back side
-	FBox mBound;
+	TArray<FVector> mOffsets;	//positions of the occurrences in component space
+};
+
+struct FMeshResultFinal
+{
+	static const int32 MaxLODs = 4;
+
+	FResultMeshData	mMeshes[3];	//front back side of LOD 0
+	FBox mBound = FBox(ForceInit);	//computed by the build, CalcBound() recomputes it from the vertices
+	TArray<FMeshResultLOD> mLODs;	//LOD 1 and further, they share the alignment and bounds of LOD 0
+	TArray<FMeshResultGlyph> mGlyphs;	//only for instanced text, mMeshes are empty then
+
+	int32 NumLODs() const { return 1 + mLODs.Num(); }
+	bool IsInstanced() const { return mGlyphs.Num() > 0; }
+	const FResultMeshData* GetLODMeshes(int32 lodIndex) const { return lodIndex == 0 ? mMeshes : mLODs[lodIndex - 1].mMeshes; }
 
 	FBox CalcBound()
 	{
@@ -55,6 +109,12 @@ struct FMeshResultFinal
 	}
 };
 
+//shared between a component and its builds, a build whose generation doesn't match anymore is cancelled
+struct FText3DBuildToken
+{
+	FThreadSafeCounter mGeneration;
+};
+
 UENUM()
 enum class EText3DHAlign : uint8
 {
@@ -87,8 +147,15 @@ public:
 	class UFontFace* Font;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int BezierStep;
+	//maximum distance between a curve and its segments, in the same units as Depth.
+	//if greater than zero each curve gets as many segments as its curvature needs and BezierStep is ignored
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0))
+	float BezierTolerance;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float Depth;
+	//neighbouring side segments that meet at less than this many degrees share smoothed normals, 0 keeps every segment flat
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ClampMax=180))
+	float SideSmoothingAngle;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool bGenerateSide;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -106,6 +173,32 @@ public:
 	//optional ISO 15924 script tag, e.g cyrl, jpan, hebr, arab, ...
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FString Script;
+	//triangulates the distinct glyphs of the text on multiple threads, shaping stays on one thread
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay)
+	bool bParallelTriangulation;
+	//minimum number of distinct glyphs needed to triangulate in parallel
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, meta=(ClampMin=1))
+	int ParallelMinGlyphs;
+	//for text that changes often, e.g counters, timers and chat. new meshes are uploaded into the existing
+	//render buffers instead of recreating the render state, and the text is drawn through the dynamic path.
+	//the lines that haven't changed since the previous build reuse their shaping and geometry
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay)
+	bool bDynamicText;
+	//most levels of detail to build, every level roughly halves the curve segments of the previous one
+	//and the last one has no side walls. levels that would give the same curves as the previous one are not built
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, meta=(ClampMin=1, ClampMax=4))
+	int NumLODs;
+	//screen size below which LOD 1 is drawn, every further LOD starts at half the screen size of the previous one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, meta=(ClampMin=0, ClampMax=1))
+	float LODScreenSize;
+	//memory layout of the generated mesh, the compact formats roughly halve its CPU and GPU memory
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay)
+	EText3DVertexFormat VertexFormat;
+	//builds each distinct glyph once and draws all its occurrences with a single instanced draw, for long text made of few glyphs.
+	//memory and draws scale with the glyphs used instead of the length of the text, and a text change only rewrites the instance offsets.
+	//the materials need to be usable with instanced static meshes. no LODs are built for instanced text
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay)
+	bool bInstanceGlyphs;
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -114,10 +207,18 @@ public:
 	//regenerates a new mesh, call this after changing any of the properties
 	UFUNCTION(BlueprintCallable)
 	void UpdateMesh();
+	//regenerates the meshes of many components at once, e.g after loading a level. components with the same font
+	//and glyph settings are built together, they share the font setup and every distinct glyph is loaded once
+	UFUNCTION(BlueprintCallable)
+	static void UpdateMeshes(const TArray<UText3DComponent*>& Components);
 
 	TSharedPtr<FMeshResultFinal, ESPMode::ThreadSafe> GeneratedMesh;
 
 	FMeshResultFinal* GetGeneratedMesh() const;
+	//builds a mesh on the calling thread without replacing the current one, e.g for baking. returns null if there is no text
+	FMeshResultFinal* BuildMeshNow();
+	//true while a new mesh is being generated, the current one is about to be replaced
+	bool IsBuildInFlight() const { return bBuildInFlight; }
 
 	virtual int32 GetNumMaterials() const override;
 
@@ -127,7 +228,30 @@ protected:
 
 
 	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
 
 private:
-	void GenerateMesh(struct FTextShaper* in);
+	friend class FText3DBuildScheduler;
+
+	//cancels the running build, returns false if the new build has to wait for it
+	bool RequestBuild();
+	//queues a build in the FText3DBuildScheduler, at most one build is queued or runs per component
+	void StartBuild();
+	//returns the shaper of a new build, or null if there is nothing to build
+	struct FTextShaper* CreateBuild();
+	//called on the game thread when the build started with the specified generation is done
+	void FinishBuild(FMeshResultFinal* mesh, int32 generation);
+	//sends GeneratedMesh to the existing scene proxy, returns false if the proxy has to be recreated
+	bool UpdateSceneProxyMesh();
+	//tells the existing scene proxy whether its mesh is being rebuilt, see FText3DSceneProxy::SetRebuilding_RenderThread
+	void SetSceneProxyRebuilding(bool bRebuilding);
+
+	static void GenerateMesh(struct FTextShaper* in);
+	//builds the shapers of a batch, they must share the font and glyph settings
+	static void GenerateMeshes(const TArray<struct FTextShaper*>& textShapers, TArray<FMeshResultFinal*>& outMeshes);
+
+	TSharedPtr<FText3DBuildToken, ESPMode::ThreadSafe> BuildToken;
+	TSharedPtr<class FText3DLineCache, ESPMode::ThreadSafe> LineCache;	//only for dynamic text
+	bool bBuildInFlight = false;
+	bool bRebuildPending = false;
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "Text3DActorDetails.h"
+#include "Text3DActor.h"
+#include "Text3DStaticMeshBaker.h"
+#include "DetailLayoutBuilder.h"
+#include "DetailCategoryBuilder.h"
+#include "DetailWidgetRow.h"
+#include "ObjectTools.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "FText3DActorDetails"
+
+TSharedRef<IDetailCustomization> FText3DActorDetails::MakeInstance()
+{
+	return MakeShareable(new FText3DActorDetails);
+}
+
+void FText3DActorDetails::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
+{
+	DetailBuilder.GetObjectsBeingCustomized(mObjects);
+
+	IDetailCategoryBuilder& category = DetailBuilder.EditCategory("Bake");
+	category.AddCustomRow(LOCTEXT("BakeToStaticMesh", "Bake To Static Mesh"))
+	.WholeRowContent()
+	[
+		SNew(SButton)
+		.ToolTipText(LOCTEXT("BakeToStaticMeshTooltip", "Creates a static mesh asset named after the actor from the text, in Bake Path"))
+		.OnClicked(this, &FText3DActorDetails::OnBakeClicked)
+		[
+			SNew(STextBlock)
+			.Font(IDetailLayoutBuilder::GetDetailFont())
+			.Text(LOCTEXT("BakeToStaticMesh", "Bake To Static Mesh"))
+		]
+	];
+}
+
+FReply FText3DActorDetails::OnBakeClicked()
+{
+	for (const TWeakObjectPtr<UObject>& object : mObjects)
+	{
+		AText3DActor* actor = Cast<AText3DActor>(object.Get());
+		if (actor && actor->TextComponent)
+			FText3DStaticMeshBaker::Bake(actor->TextComponent, actor->BakePath / ObjectTools::SanitizeObjectName(actor->GetActorLabel()));
+	}
+	return FReply::Handled();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "IDetailCustomization.h"
+
+//adds the bake button to the details of AText3DActor
+class FText3DActorDetails : public IDetailCustomization
+{
+public:
+	static TSharedRef<IDetailCustomization> MakeInstance();
+
+	virtual void CustomizeDetails(IDetailLayoutBuilder& DetailBuilder) override;
+
+private:
+	//creates a static mesh asset named after each selected actor from its text, in its BakePath. a static mesh actor
+	//showing it can replace text that never changes, it needs no font or triangulation at runtime
+	FReply OnBakeClicked();
+
+	TArray<TWeakObjectPtr<UObject>> mObjects;
+};
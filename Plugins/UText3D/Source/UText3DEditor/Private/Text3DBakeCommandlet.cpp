@@ -0,0 +1,69 @@
+#include "Text3DBakeCommandlet.h"
+#include "Text3DComponent.h"
+#include "Text3DStaticMeshBaker.h"
+#include "Text3DEditor.h"
+#include "GameFramework/Actor.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectIterator.h"
+#include "Engine/StaticMesh.h"
+#include "ObjectTools.h"
+
+UText3DBakeCommandlet::UText3DBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UText3DBakeCommandlet::Main(const FString& Params)
+{
+	FString maps, path = TEXT("/Game/Text3D");
+	if (!FParse::Value(*Params, TEXT("maps="), maps))
+	{
+		UE_LOG(Text3DEditor, Error, TEXT("usage: -run=Text3DBake -maps=<map>[+<map>...] [-path=<content path>]"));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("path="), path);
+
+	TArray<FString> mapNames;
+	maps.ParseIntoArray(mapNames, TEXT("+"), true);
+
+	int32 numFailed = 0;
+	for (const FString& mapName : mapNames)
+	{
+		UPackage* mapPackage = LoadPackage(nullptr, *mapName, LOAD_None);
+		if (mapPackage == nullptr)
+		{
+			UE_LOG(Text3DEditor, Error, TEXT("failed to load %s"), *mapName);
+			numFailed++;
+			continue;
+		}
+
+		TArray<UText3DComponent*> components;
+		for (TObjectIterator<UText3DComponent> iter; iter; ++iter)
+		{
+			if (iter->GetOutermost() == mapPackage && !iter->IsTemplate())
+				components.Add(*iter);
+		}
+
+		for (UText3DComponent* component : components)
+		{
+			const AActor* owner = component->GetOwner();
+			const FString assetName = ObjectTools::SanitizeObjectName(FString::Printf(TEXT("%s_%s_%s"),
+				*FPackageName::GetShortName(mapPackage), owner ? *owner->GetName() : TEXT("None"), *component->GetName()));
+			const FString packageName = path / assetName;
+
+			UStaticMesh* staticMesh = FText3DStaticMeshBaker::Bake(component, packageName);
+			const FString fileName = FPackageName::LongPackageNameToFilename(packageName, FPackageName::GetAssetPackageExtension());
+			if (staticMesh == nullptr || !UPackage::SavePackage(staticMesh->GetOutermost(), staticMesh, RF_Standalone, *fileName))
+			{
+				UE_LOG(Text3DEditor, Error, TEXT("failed to bake %s"), *component->GetPathName());
+				numFailed++;
+			}
+		}
+		UE_LOG(Text3DEditor, Display, TEXT("%s: %d text components baked"), *mapName, components.Num());
+	}
+	return numFailed ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "Text3DBakeCommandlet.generated.h"
+
+//bakes every UText3DComponent of the specified maps to static mesh assets and saves them, e.g
+//UE4Editor-Cmd Text3DProject -run=Text3DBake -maps=/Game/Maps/Level1+/Game/Maps/Level2 [-path=/Game/Text3D]
+//the assets are named <map>_<actor>_<component>. the maps are not changed, see FText3DStaticMeshBaker
+UCLASS()
+class UText3DBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UText3DBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
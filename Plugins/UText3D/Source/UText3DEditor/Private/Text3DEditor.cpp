@@ -0,0 +1,25 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "Text3DEditor.h"
+#include "Text3DActorDetails.h"
+#include "PropertyEditorModule.h"
+
+#define LOCTEXT_NAMESPACE "FText3DEditorModule"
+
+void FText3DEditorModule::StartupModule()
+{
+	FPropertyEditorModule& propertyModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>("PropertyEditor");
+	propertyModule.RegisterCustomClassLayout("Text3DActor", FOnGetDetailCustomizationInstance::CreateStatic(&FText3DActorDetails::MakeInstance));
+}
+
+void FText3DEditorModule::ShutdownModule()
+{
+	if (FPropertyEditorModule* propertyModule = FModuleManager::GetModulePtr<FPropertyEditorModule>("PropertyEditor"))
+		propertyModule->UnregisterCustomClassLayout("Text3DActor");
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FText3DEditorModule, UText3DEditor)
+
+DEFINE_LOG_CATEGORY(Text3DEditor)
@@ -0,0 +1,123 @@
+#include "Text3DStaticMeshBaker.h"
+#include "Text3DComponent.h"
+#include "Text3DEditor.h"
+#include "Engine/StaticMesh.h"
+#include "RawMesh.h"
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+//appends a part of the generated mesh to a raw mesh, moved by offset
+static void AppendToRawMesh(const FResultMeshData& part, int32 materialIndex, const FVector& offset, FRawMesh& rawMesh)
+{
+	const int32 baseVertex = rawMesh.VertexPositions.Num();
+	for (int32 iVertex = 0; iVertex < part.NumVertices(); iVertex++)
+		rawMesh.VertexPositions.Add(part.GetPosition(iVertex) + offset);
+
+	//the text has no texture coordinates, the static mesh needs one channel anyway
+	for (int32 iIndex = 0; iIndex + 3 <= part.NumIndices(); iIndex += 3)
+	{
+		for (int32 iCorner = 0; iCorner < 3; iCorner++)
+		{
+			const int32 index = part.GetIndex(iIndex + iCorner);
+			rawMesh.WedgeIndices.Add(baseVertex + index);
+			rawMesh.WedgeTangentZ.Add(part.GetNormal(index));
+			rawMesh.WedgeTexCoords[0].Add(FVector2D::ZeroVector);
+		}
+		rawMesh.FaceMaterialIndices.Add(materialIndex);
+		rawMesh.FaceSmoothingMasks.Add(0);
+	}
+}
+
+UStaticMesh* FText3DStaticMeshBaker::Bake(UText3DComponent* component, const FString& packageName)
+{
+	TUniquePtr<FMeshResultFinal> mesh(component->BuildMeshNow());
+	if (!mesh.IsValid())
+	{
+		UE_LOG(Text3DEditor, Error, TEXT("%s has no text to bake"), *component->GetPathName());
+		return nullptr;
+	}
+
+	const FString assetName = FPackageName::GetLongPackageAssetName(packageName);
+	UPackage* package = CreatePackage(nullptr, *packageName);
+	UStaticMesh* staticMesh = FindObject<UStaticMesh>(package, *assetName);
+	const bool bNewAsset = staticMesh == nullptr;
+	if (bNewAsset)
+		staticMesh = NewObject<UStaticMesh>(package, *assetName, RF_Public | RF_Standalone);
+	else
+		staticMesh->PreEditChange(nullptr);
+
+	staticMesh->SourceModels.Empty();
+	staticMesh->SectionInfoMap.Clear();
+	staticMesh->StaticMaterials.Empty();
+	staticMesh->bAutoComputeLODScreenSize = false;
+
+	static const FName slotNames[3] = { TEXT("Front"), TEXT("Back"), TEXT("Side") };
+	for (int32 iMaterial = 0; iMaterial < 3; iMaterial++)
+		staticMesh->StaticMaterials.Add(FStaticMaterial(component->GetMaterial(iMaterial), slotNames[iMaterial], slotNames[iMaterial]));
+
+	for (int32 iLOD = 0; iLOD < mesh->NumLODs(); iLOD++)
+	{
+		//instanced text is expanded, the static mesh pipeline does its own instancing
+		FRawMesh rawMesh;
+		bool bHasPart[3] = { false, false, false };
+		for (int32 iPart = 0; iPart < 3; iPart++)
+		{
+			if (mesh->IsInstanced())
+			{
+				for (const FMeshResultGlyph& glyph : mesh->mGlyphs)
+				{
+					bHasPart[iPart] |= glyph.mMeshes[iPart].NumIndices() >= 3;
+					for (const FVector& offset : glyph.mOffsets)
+						AppendToRawMesh(glyph.mMeshes[iPart], iPart, offset, rawMesh);
+				}
+			}
+			else
+			{
+				const FResultMeshData& part = mesh->GetLODMeshes(iLOD)[iPart];
+				bHasPart[iPart] = part.NumIndices() >= 3;
+				AppendToRawMesh(part, iPart, FVector::ZeroVector, rawMesh);
+			}
+		}
+
+		if (!rawMesh.IsValid())
+		{
+			UE_LOG(Text3DEditor, Error, TEXT("%s has no geometry in LOD %d"), *component->GetPathName(), iLOD);
+			break;
+		}
+
+		FStaticMeshSourceModel* sourceModel = new (staticMesh->SourceModels) FStaticMeshSourceModel();
+		sourceModel->BuildSettings.bRecomputeNormals = false;
+		sourceModel->BuildSettings.bRecomputeTangents = true;
+		sourceModel->BuildSettings.bRemoveDegenerates = true;
+		sourceModel->BuildSettings.bGenerateLightmapUVs = false;
+		sourceModel->ScreenSize = iLOD == 0 ? 1.0f : component->LODScreenSize / (1 << (iLOD - 1));
+		sourceModel->RawMeshBulkData->SaveRawMesh(rawMesh);
+
+		//the sections are the parts with geometry in material order, a part may be missing
+		int32 sectionIndex = 0;
+		for (int32 iPart = 0; iPart < 3; iPart++)
+		{
+			if (bHasPart[iPart])
+				staticMesh->SectionInfoMap.Set(iLOD, sectionIndex++, FMeshSectionInfo(iPart));
+		}
+	}
+
+	if (staticMesh->SourceModels.Num() == 0)
+	{
+		if (bNewAsset)
+			staticMesh->ClearFlags(RF_Public | RF_Standalone);
+		return nullptr;
+	}
+
+	staticMesh->ImportVersion = EImportStaticMeshVersion::LastVersion;
+	staticMesh->Build(false);
+	staticMesh->PostEditChange();
+	staticMesh->MarkPackageDirty();
+
+	if (bNewAsset)
+		FAssetRegistryModule::AssetCreated(staticMesh);
+
+	UE_LOG(Text3DEditor, Display, TEXT("baked %s to %s, %d LODs"), *component->GetPathName(), *packageName, staticMesh->SourceModels.Num());
+	return staticMesh;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UText3DComponent;
+class UStaticMesh;
+
+//converts generated text into static mesh assets, so text that never changes needs no font, shaping or triangulation at runtime
+struct FText3DStaticMeshBaker
+{
+	//builds the text of the component on the calling thread and stores it in the static mesh asset of the package,
+	//an existing asset is replaced. the materials keep the front, back and side slots of the component and every
+	//LOD of the text becomes a LOD of the static mesh. the package is marked dirty but not saved. returns null on failure
+	static UStaticMesh* Bake(UText3DComponent* component, const FString& packageName);
+};
@@ -0,0 +1,47 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+//editor tools of UText3D, everything that needs UnrealEd lives here so the runtime module doesn't
+public class UText3DEditor : ModuleRules
+{
+	public UText3DEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicIncludePaths.AddRange(
+			new string[] {
+				"UText3DEditor/Public"
+			}
+			);
+
+		PrivateIncludePaths.AddRange(
+			new string[] {
+				"UText3DEditor/Private"
+			}
+			);
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+			}
+			);
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"CoreUObject",
+				"Engine",
+				"Slate",
+				"SlateCore",
+				"UnrealEd",
+				"PropertyEditor",
+				"RawMesh",
+				"AssetRegistry",
+
+				"UText3D",
+			}
+			);
+	}
+}